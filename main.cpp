@@ -4,9 +4,12 @@
 
 #include <stdio.h>
 #include <stdlib.h>
-#include <list>
+#include <vector>
 #include "IPlatform.h"
 
+#include "Animator.h"
+#include "ParticleEmitter.h"
+#include "SceneLoader.h"
 #include "ShapeDrawing.h"
 
 int main(int argc, char* argv[])
@@ -15,24 +18,51 @@ int main(int argc, char* argv[])
    IPlatform& rPlatform = IPlatform::instance();
 
    // TODO: Switch to smart pointer
-   std::list<IPrimitive*> sceneGraph;
-   // Create some shapes
-   sceneGraph.push_back(new CLine(0.0f, 0.0f, -0.7f, -0.5f, (10.0f / 1024.0f)));
-   sceneGraph.push_back(new CCircle(0.6f, 0.5f, 0.2f, 35));
-   sceneGraph.push_back(new CCircleLine(-0.6f, -0.5f, 0.2f, 35));
-   sceneGraph.push_back(new CFanLine(-0.6f, 0.5f, 0.2f, 15, 0, 180));
-   sceneGraph.push_back(new CFan(-0.4, 0.1f, 200.0 / 1024.0, 10, 90, 180));
-   sceneGraph.push_back(new CRoundRectangle(-0.9, 0.9, 0.9, -0.9, 40.0 / 1024.0));
-   sceneGraph.push_back(new BaseSprite({-0.5, 0.0, -1.0, -1.0}, "assets/logo32.png" ));
-   // Instanciate all shapes
-   for(auto s : sceneGraph)
+   std::vector<IPrimitive*> sceneGraph;
+   if (argc > 1)
    {
-      s->Instantiate();
+      // Binary scene from SceneCompiler, instantiated by the loader
+      if (!SceneLoader::Load(argv[1], sceneGraph))
+      {
+         rPlatform.Terminate();
+         return EXIT_FAILURE;
+      }
+   }
+   else
+   {
+      // Create some shapes
+      sceneGraph.push_back(new CLine(0.0f, 0.0f, -0.7f, -0.5f, (10.0f / 1024.0f)));
+      sceneGraph.push_back(new CCircle(0.6f, 0.5f, 0.2f, 35));
+      // UI rule laid out in pixels, one pixel wide and crisp
+      CLine* pRule = new CLine(64.0f, 24.0f, 960.0f, 24.0f, 1.0f);
+      pRule->SetPixelSpace(true);
+      sceneGraph.push_back(pRule);
+      sceneGraph.push_back(new CCircleLine(-0.6f, -0.5f, 0.2f, 35));
+      CFanLine* pFanLine = new CFanLine(-0.6f, 0.5f, 0.2f, 15, 0, 180);
+      sceneGraph.push_back(pFanLine);
+      sceneGraph.push_back(new CFan(-0.4, 0.1f, 200.0 / 1024.0, 10, 90, 180));
+      sceneGraph.push_back(new CRoundRectangle(-0.9, 0.9, 0.9, -0.9, 40.0 / 1024.0));
+      sceneGraph.push_back(new BaseSprite({-0.5, 0.0, -1.0, -1.0}, "assets/logo32.png" ));
+      // at most 2 s of life, 200 per second stay under the 512 particles
+      ParticleEmitter* pEmitter = new ParticleEmitter(0.6f, -0.6f, 512);
+      pEmitter->SetRate(200.0f);
+      pEmitter->SetGravity(0.0f, -0.3f);
+      sceneGraph.push_back(pEmitter);
+      // Instanciate all shapes
+      for(auto s : sceneGraph)
+      {
+         s->Instantiate();
+      }
+      // Spin the fan line around its center
+      Animator::instance().Tween(pFanLine, Animator::ROTATION, 360.0f, 4.0, Animator::LINEAR);
    }
 
    while (!rPlatform.ShouldExit())
    {
       rPlatform.FrameBegin();
+
+      // Advance the animations (transforms and opacity only)
+      Animator::instance().Update(rPlatform.CurrentTime());
       
       // Draw Everything
       for(auto s : sceneGraph)
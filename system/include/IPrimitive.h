@@ -10,9 +10,18 @@ public:
    virtual void Instantiate() = 0;
    virtual void Draw() = 0;
 
+   //! @brief Packet drawn by the primitive, nullptr before Instantiate().
+   RenderPacket* GetRenderPacket() const { return mpRenderPacket; }
+
+   //! @brief Selects pixel coordinates (origin top left, y down, snapped to whole pixels)
+   //! instead of clip space, for UI layout. Call before Instantiate().
+   void SetPixelSpace(bool bPixelSpace) { mbPixelSpace = bPixelSpace; }
+   bool IsPixelSpace() const { return mbPixelSpace; }
+
    IPrimitive(const IPrimitive&) = delete;
    IPrimitive& operator=(const IPrimitive&) = delete;
 protected:
    RenderPacket* mpRenderPacket = nullptr;
+   bool mbPixelSpace = false;
 
 };
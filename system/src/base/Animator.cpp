@@ -0,0 +1,344 @@
+#include "Animator.h"
+
+#include <algorithm>
+#include <cmath>
+
+#include "IPlatform.h"
+#include "IPrimitive.h"
+#include "RenderPacket.h"
+
+constexpr float DEG2RAD = 0.0174533f;
+
+// Ratio between a clip space unit across and up, so rotations keep their shape on screen
+static float Aspect()
+{
+   IPlatform& rPlatform = IPlatform::instance();
+   return static_cast<float>(rPlatform.ScreenPixelWidth()) / rPlatform.ScreenPixelHeight();
+}
+
+static float Ease(Animator::Easing easing, float t)
+{
+   switch (easing)
+   {
+      case Animator::EASE_IN:
+         return t * t;
+      case Animator::EASE_OUT:
+         return t * (2.0f - t);
+      case Animator::EASE_IN_OUT:
+         return t * t * (3.0f - (2.0f * t));
+      default:
+         return t;
+   }
+}
+
+Animator& Animator::instance()
+{
+   static Animator animator;
+   return animator;
+}
+
+Animator::Animator()
+{
+}
+
+Animator::~Animator()
+{
+}
+
+uint32_t Animator::NodeIndex(IPrimitive* pPrimitive)
+{
+   auto it = mIndex.find(pPrimitive);
+   if (it != mIndex.end())
+   {
+      return it->second;
+   }
+
+   Node n;
+   n.pPrimitive = pPrimitive;
+   n.value[POSITION_X] = 0;
+   n.value[POSITION_Y] = 0;
+   n.value[ROTATION] = 0;
+   n.value[SCALE_X] = 1;
+   n.value[SCALE_Y] = 1;
+   n.value[OPACITY] = 1;
+   n.pivotX = 0;
+   n.pivotY = 0;
+   n.bInitialized = false;
+   n.bChanged = false;
+   n.packet = 0;
+   InitNode(n);
+
+   uint32_t index = static_cast<uint32_t>(mNodes.size());
+   mNodes.push_back(n);
+   mIndex[pPrimitive] = index;
+   return index;
+}
+
+void Animator::InitNode(Node& n)
+{
+   RenderPacket* pPacket = n.pPrimitive->GetRenderPacket();
+   if (!n.bInitialized && pPacket)
+   {
+      // undo Apply(): m0 = c * sx, m1 = s * aspect * sx, m4 = -s / aspect * sy, m5 = c * sy
+      const Matrix4& m = pPacket->mTransform;
+      float aspect = pPacket->mbPixelSpace ? 1.0f : Aspect();
+      float cx = m[0];
+      float sx = m[1] / aspect;
+      float sy = -m[4] * aspect;
+      float cy = m[5];
+
+      // values set before the packet existed are on top of it, the translation is the
+      // position moved by the pivot (see Apply())
+      n.value[POSITION_X] += m[12] - n.pivotX + ((m[0] * n.pivotX) + (m[4] * n.pivotY));
+      n.value[POSITION_Y] += m[13] - n.pivotY + ((m[1] * n.pivotX) + (m[5] * n.pivotY));
+      n.value[ROTATION] += atan2f(sx, cx) / DEG2RAD;
+      n.value[SCALE_X] *= sqrtf((cx * cx) + (sx * sx));
+      n.value[SCALE_Y] *= sqrtf((cy * cy) + (sy * sy));
+      n.value[OPACITY] *= pPacket->mfOpacity;
+      n.bInitialized = true;
+      Remember(n, pPacket);
+   }
+}
+
+void Animator::Remember(Node& n, const RenderPacket* pPacket)
+{
+   const Matrix4& m = pPacket->mTransform;
+   n.packet = pPacket->miSerial;
+   n.applied[0] = m[0];
+   n.applied[1] = m[1];
+   n.applied[2] = m[4];
+   n.applied[3] = m[5];
+   n.applied[4] = m[12];
+   n.applied[5] = m[13];
+   n.applied[6] = pPacket->mfOpacity;
+}
+
+bool Animator::Replaced(const Node& n) const
+{
+   const RenderPacket* pPacket = n.pPrimitive->GetRenderPacket();
+   return n.bInitialized && pPacket && (pPacket->miSerial != n.packet);
+}
+
+bool Animator::Edited(const Node& n) const
+{
+   const RenderPacket* pPacket = n.pPrimitive->GetRenderPacket();
+   if (!n.bInitialized || !pPacket || (pPacket->miSerial != n.packet))
+   {
+      return false;
+   }
+   const Matrix4& m = pPacket->mTransform;
+   return (m[0] != n.applied[0]) || (m[1] != n.applied[1]) || (m[4] != n.applied[2]) ||
+          (m[5] != n.applied[3]) || (m[12] != n.applied[4]) || (m[13] != n.applied[5]) ||
+          (pPacket->mfOpacity != n.applied[6]);
+}
+
+void Animator::Reseed(Node& n)
+{
+   n.value[POSITION_X] = 0;
+   n.value[POSITION_Y] = 0;
+   n.value[ROTATION] = 0;
+   n.value[SCALE_X] = 1;
+   n.value[SCALE_Y] = 1;
+   n.value[OPACITY] = 1;
+   n.bInitialized = false;
+   InitNode(n);
+}
+
+void Animator::StopTween(uint32_t node, Property property)
+{
+   for (size_t i = 0; i < mActive.size(); i++)
+   {
+      if ((mActive[i].node == node) && (mActive[i].property == property))
+      {
+         mActive[i] = mActive.back();
+         mActive.pop_back();
+         return;
+      }
+   }
+}
+
+void Animator::Tween(IPrimitive* pPrimitive, Property property, float to, double duration,
+                     Easing easing, double delay)
+{
+   uint32_t node = NodeIndex(pPrimitive);
+   StopTween(node, property);
+
+   Active a;
+   a.node = node;
+   a.property = property;
+   a.easing = easing;
+   a.bStarted = false;
+   a.from = 0;
+   a.to = to;
+   a.start = -1;
+   a.delay = delay;
+   a.duration = duration;
+   mActive.push_back(a);
+}
+
+void Animator::Set(IPrimitive* pPrimitive, Property property, float value)
+{
+   uint32_t node = NodeIndex(pPrimitive);
+   StopTween(node, property);
+   Node& n = mNodes[node];
+   n.value[property] = value;
+   Apply(n, Aspect());
+}
+
+float Animator::Get(IPrimitive* pPrimitive, Property property)
+{
+   Node& n = mNodes[NodeIndex(pPrimitive)];
+   InitNode(n);
+   return n.value[property];
+}
+
+void Animator::SetPivot(IPrimitive* pPrimitive, float x, float y)
+{
+   Node& n = mNodes[NodeIndex(pPrimitive)];
+   n.pivotX = x;
+   n.pivotY = y;
+   Apply(n, Aspect());
+}
+
+bool Animator::IsAnimating(const IPrimitive* pPrimitive) const
+{
+   auto it = mIndex.find(pPrimitive);
+   if (it == mIndex.end())
+   {
+      return false;
+   }
+   for (const Active& a : mActive)
+   {
+      if (a.node == it->second)
+         return true;
+   }
+   return false;
+}
+
+void Animator::Remove(IPrimitive* pPrimitive)
+{
+   auto it = mIndex.find(pPrimitive);
+   if (it == mIndex.end())
+   {
+      return;
+   }
+   uint32_t node = it->second;
+   mIndex.erase(it);
+
+   // drop its tweens, then move the last node into the hole
+   for (size_t i = 0; i < mActive.size();)
+   {
+      if (mActive[i].node == node)
+      {
+         mActive[i] = mActive.back();
+         mActive.pop_back();
+      }
+      else
+      {
+         i++;
+      }
+   }
+   uint32_t last = static_cast<uint32_t>(mNodes.size() - 1);
+   if (node != last)
+   {
+      mNodes[node] = mNodes[last];
+      mIndex[mNodes[node].pPrimitive] = node;
+      for (Active& a : mActive)
+      {
+         if (a.node == last)
+            a.node = node;
+      }
+   }
+   mNodes.pop_back();
+}
+
+void Animator::Apply(Node& n, float aspect)
+{
+   RenderPacket* pPacket = n.pPrimitive->GetRenderPacket();
+   if (!pPacket)
+   {
+      n.bChanged = true;  // try again once instantiated
+      return;
+   }
+   InitNode(n);
+
+   // rotation * scale, the rotation done in pixel proportions (pixel space already is)
+   if (pPacket->mbPixelSpace)
+   {
+      aspect = 1.0f;
+   }
+   float r = n.value[ROTATION] * DEG2RAD;
+   float c = cos(r);
+   float s = sin(r);
+   float m0 = c * n.value[SCALE_X];
+   float m1 = s * aspect * n.value[SCALE_X];
+   float m4 = (-s / aspect) * n.value[SCALE_Y];
+   float m5 = c * n.value[SCALE_Y];
+
+   Matrix4& m = pPacket->mTransform;
+   m[0] = m0;
+   m[1] = m1;
+   m[4] = m4;
+   m[5] = m5;
+   // keep the pivot in place
+   m[12] = n.value[POSITION_X] + n.pivotX - ((m0 * n.pivotX) + (m4 * n.pivotY));
+   m[13] = n.value[POSITION_Y] + n.pivotY - ((m1 * n.pivotX) + (m5 * n.pivotY));
+   pPacket->mfOpacity = n.value[OPACITY];
+   Remember(n, pPacket);
+   n.bChanged = false;
+}
+
+void Animator::Update(double time)
+{
+   // a transform the primitive changed in place (SetCenter()...) is the new state
+   for (Node& n : mNodes)
+   {
+      if (Edited(n))
+         Reseed(n);
+   }
+
+   // evaluate every running tween in one pass, finished ones are swapped out
+   for (size_t i = 0; i < mActive.size();)
+   {
+      Active& a = mActive[i];
+      if (a.start < 0)
+      {
+         a.start = time + a.delay;
+      }
+      double elapsed = time - a.start;
+      if (elapsed < 0)
+      {
+         i++;
+         continue;
+      }
+
+      Node& n = mNodes[a.node];
+      if (!a.bStarted)
+      {
+         InitNode(n);
+         a.from = n.value[a.property];
+         a.bStarted = true;
+      }
+      float t = (a.duration > 0) ? static_cast<float>(std::min(elapsed / a.duration, 1.0)) : 1.0f;
+      n.value[a.property] = a.from + ((a.to - a.from) * Ease(a.easing, t));
+      n.bChanged = true;
+
+      if (t >= 1.0f)
+      {
+         mActive[i] = mActive.back();
+         mActive.pop_back();
+      }
+      else
+      {
+         i++;
+      }
+   }
+
+   // then touch each changed packet once, and the ones the primitives created again
+   float aspect = Aspect();
+   for (Node& n : mNodes)
+   {
+      if (n.bChanged || Replaced(n))
+         Apply(n, aspect);
+   }
+}
@@ -0,0 +1,140 @@
+//****************************************************************************
+//! @file
+//! @brief Tweens of the primitive transforms and opacity (Singleton).
+//!
+//! Animations only change the render packet transform and the uColor alpha, the vertices
+//! are never regenerated or uploaded again.
+//****************************************************************************
+#ifndef __ANIMATOR_H__
+#define __ANIMATOR_H__
+
+#include <stdint.h>
+#include <unordered_map>
+#include <vector>
+
+class IPrimitive;
+class RenderPacket;
+
+//! @brief Animates position, rotation, scale and opacity of primitives.
+//! @par Classic Singleton pattern. All running tweens are evaluated in one pass by Update(),
+//! called once per frame, then every changed packet gets its transform rewritten.
+//! @par The transform is translation * rotation * scale around the pivot, on top of the
+//! vertices built by the primitive. The properties start from the packet transform set by
+//! the primitive (a CPath scale is SCALE_X/Y). A packet the primitive creates again gets the
+//! animated state back at the next Update(), a transform the primitive changes in place
+//! (CCircle::SetCenter()) replaces the animated state. Call Remove() before deleting an
+//! animated primitive.
+class Animator
+{
+  private:
+   //! @brief private constructor
+   Animator();
+
+  public:
+   //! @brief Animated properties
+   enum Property
+   {
+      POSITION_X = 0,  //!< Translation x
+      POSITION_Y,      //!< Translation y
+      ROTATION,        //!< Degrees, counter clockwise
+      SCALE_X,
+      SCALE_Y,
+      OPACITY,         //!< Multiplied with the uColor alpha
+      NUM_PROPERTIES
+   };
+
+   //! @brief Easing curves
+   enum Easing
+   {
+      LINEAR = 0,
+      EASE_IN,      //!< Quadratic, slow start
+      EASE_OUT,     //!< Quadratic, slow end
+      EASE_IN_OUT   //!< Smoothstep
+   };
+
+   //! @brief Return the instance of the singleton
+   //! @return reference to the singleton instance
+   static Animator& instance();
+
+   //! @brief Start a tween from the current value of the property. A running tween of the
+   //! same property is replaced.
+   //! @param[in] pPrimitive Instantiated primitive to animate
+   //! @param[in] property Property to change
+   //! @param[in] to Final value
+   //! @param[in] duration Seconds
+   //! @param[in] easing Easing curve
+   //! @param[in] delay Seconds to wait before starting (the start value is taken then)
+   void Tween(IPrimitive* pPrimitive, Property property, float to, double duration,
+              Easing easing = EASE_IN_OUT, double delay = 0);
+
+   //! @brief Set a property immediately (stops its tween).
+   void Set(IPrimitive* pPrimitive, Property property, float value);
+
+   //! @brief Current value of a property.
+   float Get(IPrimitive* pPrimitive, Property property);
+
+   //! @brief Point the rotation and scale are applied around (shape units).
+   void SetPivot(IPrimitive* pPrimitive, float x, float y);
+
+   //! @brief true while the primitive has running tweens.
+   bool IsAnimating(const IPrimitive* pPrimitive) const;
+
+   //! @brief Stop the tweens of a primitive and forget it. The packet keeps its transform.
+   void Remove(IPrimitive* pPrimitive);
+
+   //! @brief Evaluate all tweens and update the changed packets. Call once per frame.
+   //! Tweens start at the first Update() after they are created.
+   //! @param[in] time Current time in seconds (IPlatform::CurrentTime()).
+   void Update(double time);
+
+   ~Animator();
+
+  private:
+   //! @brief Animated state of one primitive
+   struct Node
+   {
+      IPrimitive* pPrimitive;
+      float value[NUM_PROPERTIES];
+      float pivotX, pivotY;
+      bool bInitialized;  //!< Transform read from the packet
+      bool bChanged;      //!< Packet needs the new state
+      unsigned int packet;    //!< RenderPacket::miSerial of the packet last written
+      float applied[7];       //!< Transform 0, 1, 4, 5, 12, 13 and opacity last written
+   };
+
+   //! @brief A running tween
+   struct Active
+   {
+      uint32_t node;
+      Property property;
+      Easing easing;
+      bool bStarted;
+      float from, to;
+      double start;     //!< Start time, negative until the first Update()
+      double delay;
+      double duration;
+   };
+
+   //! @brief Node of a primitive, created if needed
+   uint32_t NodeIndex(IPrimitive* pPrimitive);
+   //! @brief Read the primitive transform once its packet exists
+   void InitNode(Node& n);
+   //! @brief Note the packet and the transform it holds now
+   void Remember(Node& n, const RenderPacket* pPacket);
+   //! @brief true if the primitive created a new packet since it was remembered
+   bool Replaced(const Node& n) const;
+   //! @brief true if the primitive changed the transform of the remembered packet
+   bool Edited(const Node& n) const;
+   //! @brief Read the state again from the packet transform
+   void Reseed(Node& n);
+   //! @brief Remove the running tween of a property
+   void StopTween(uint32_t node, Property property);
+   //! @brief Rewrite the packet transform and opacity of a node
+   void Apply(Node& n, float aspect);
+
+   std::vector<Node> mNodes;
+   std::vector<Active> mActive;
+   std::unordered_map<const IPrimitive*, uint32_t> mIndex;
+};
+
+#endif  // __ANIMATOR_H__
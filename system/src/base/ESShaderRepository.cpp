@@ -8,17 +8,21 @@
 
 #define SHADER_GLSLV(VERSION, SHADER) "#version " #VERSION " es\n" #SHADER
 
+// All vertex shaders compute uProjection * uModelview * aPosition. uProjection is the
+// identity for clip space packets and maps pixels to clip space for pixel space packets.
+
 // Fragment and vertex shaders code
 static const char* pColorSpriteFragShader = SHADER_GLSLV(
     320, 
     precision mediump float; 
+    uniform vec4 uColor; 
     uniform sampler2D uSampler2d; 
     layout(location = 0) in vec2 v_texCoord; 
     layout(location = 1) in vec4 vColor;
     layout(location = 0) out vec4 fragColor; 
     void main(void) 
     {
-        vec4 color = texture(uSampler2d, v_texCoord) * vColor;
+        vec4 color = texture(uSampler2d, v_texCoord) * vColor * uColor;
         if (color.a > 0.1)
             fragColor = color;
         else
@@ -29,6 +33,7 @@ static const char* pColorSpriteVertShader = SHADER_GLSLV(
     320, 
     precision mediump float; 
     uniform mat4 uModelview; 
+    uniform mat4 uProjection; 
     layout(location = 0) in vec4 aPosition; 
     layout(location = 1) in vec2 aUV;
     layout(location = 2) in vec4 aColor; 
@@ -38,18 +43,19 @@ static const char* pColorSpriteVertShader = SHADER_GLSLV(
     {
         vColor = aColor;
         v_texCoord = aUV.st;
-        gl_Position = uModelview * aPosition;
+        gl_Position = uProjection * uModelview * aPosition;
     });
 
 static const char* pBasicSpriteFragShader = SHADER_GLSLV(
     320, 
     precision mediump float; 
+    uniform vec4 uColor; 
     uniform sampler2D uSampler2d; 
     layout(location = 0) in vec2 v_texCoord;
     layout(location = 0) out vec4 fragColor; 
     void main(void) 
     {
-        vec4 color = texture(uSampler2d, v_texCoord);
+        vec4 color = texture(uSampler2d, v_texCoord) * uColor;
         if (color.a > 0.1)
             fragColor = color;
         else
@@ -62,25 +68,25 @@ static const char* pBasicSpriteVertShader = SHADER_GLSLV(
     layout(location = 0) in vec4 aPosition; 
     layout(location = 1) in vec2 aUV; 
     uniform mat4 uModelview;
+    uniform mat4 uProjection;
     layout(location = 0) out vec2 v_texCoord; 
     void main() 
     {
         v_texCoord = aUV.st;
-        gl_Position = uModelview * aPosition;
+        gl_Position = uProjection * uModelview * aPosition;
     });
 
 static const char* pColorFillFragShader = SHADER_GLSLV(
     320, 
     precision mediump float; 
+    uniform vec4 uColor; 
     layout(location = 0) in vec4 vColor; 
     out vec4 fragColor; 
     void main(void) 
     {
-        if (vColor.a > 0.1)
-        {
-            fragColor = vColor;
-            fragColor.a = vColor.a;
-        }
+        vec4 color = vColor * uColor;
+        if (color.a > 0.0)
+            fragColor = color;
         else
             discard;
     });
@@ -89,13 +95,14 @@ static const char* pColorFillVertShader = SHADER_GLSLV(
     320, 
     precision mediump float; 
     uniform mat4 uModelview; 
+    uniform mat4 uProjection; 
     in vec4 aPosition; 
     in vec4 aColor;
     layout(location = 0) out vec4 vColor; 
     void main() 
     {
         vColor = aColor;
-        gl_Position = uModelview * aPosition;
+        gl_Position = uProjection * uModelview * aPosition;
     });
 static const char* pFontVertexShader = SHADER_GLSLV(
     320, 
@@ -103,11 +110,12 @@ static const char* pFontVertexShader = SHADER_GLSLV(
     layout(location = 0) in vec4 aPosition; 
     layout(location = 1) in vec2 aUV; 
     uniform mat4 uModelview;
+    uniform mat4 uProjection;
     layout(location = 0) out vec2 v_texCoord; 
     void main() 
     {
         v_texCoord = aUV.st;
-        gl_Position = uModelview * aPosition;
+        gl_Position = uProjection * uModelview * aPosition;
     });
 
 static const char* pFontFragmentShader = SHADER_GLSLV(
@@ -119,8 +127,151 @@ static const char* pFontFragmentShader = SHADER_GLSLV(
     layout(location = 0) out vec4 vColor; 
     void main(void) 
     {
-        vColor = texture(uSampler2d, v_texCoord);
-        vColor.rgb = uColor.rgb;
+        float coverage = texture(uSampler2d, v_texCoord).r;
+        vColor = vec4(uColor.rgb, uColor.a * coverage);
+    });
+
+// Distance field glyphs (FONT_SDF), same vertices as FONT. The texture holds the distance to
+// the glyph edge, 0.5 on the edge and larger inside, so the glyphs stay sharp at any scale:
+// the edge is antialiased over one screen pixel whatever the magnification.
+static const char* pFontSdfFragmentShader = SHADER_GLSLV(
+    320, 
+    precision mediump float; 
+    uniform vec4 uColor; 
+    uniform sampler2D uSampler2d;
+    layout(location = 0) in vec2 v_texCoord; 
+    layout(location = 0) out vec4 vColor; 
+    void main(void) 
+    {
+        float d = texture(uSampler2d, v_texCoord).r;
+        float w = max(0.5 * fwidth(d), 0.0001);
+        float coverage = smoothstep(0.5 - w, 0.5 + w, d);
+        vColor = vec4(uColor.rgb, uColor.a * coverage);
+    });
+
+// Gradient fill, COLOR_FILL with the color taken from a gradient of the vertex position
+// (before the transform, so the gradient moves with the shape).
+// uParams[0] = (type, ramp, 0, 0): type 0 linear, 1 radial. ramp 1 samples the 256x1
+// gradient texture, 0 blends uParams[2] to uParams[3].
+// uParams[1] = linear: (x0, y0, x1, y1), radial: (center x, center y, radius x, radius y)
+static const char* pGradientFillFragShader = SHADER_GLSLV(
+    320, 
+    precision highp float; 
+    uniform vec4 uColor; 
+    uniform vec4 uParams[4]; 
+    uniform sampler2D uSampler2d; 
+    layout(location = 0) in vec4 vColor; 
+    layout(location = 1) in vec2 vLocal; 
+    out vec4 fragColor; 
+    void main(void) 
+    {
+        vec4 g = uParams[1];
+        float t;
+        if (uParams[0].x < 0.5)
+        {
+            vec2 d = g.zw - g.xy;
+            t = dot(vLocal - g.xy, d) / max(dot(d, d), 0.000001);
+        }
+        else
+            t = length((vLocal - g.xy) / max(g.zw, vec2(0.000001)));
+        t = clamp(t, 0.0, 1.0);
+
+        vec4 ramp;
+        if (uParams[0].y > 0.5)
+            ramp = texture(uSampler2d, vec2((0.5 + (t * 255.0)) / 256.0, 0.5));
+        else
+            ramp = mix(uParams[2], uParams[3], t);
+
+        vec4 color = ramp * vColor * uColor;
+        if (color.a > 0.0)
+            fragColor = color;
+        else
+            discard;
+    });
+
+static const char* pGradientFillVertShader = SHADER_GLSLV(
+    320, 
+    precision highp float; 
+    uniform mat4 uModelview; 
+    uniform mat4 uProjection; 
+    in vec4 aPosition; 
+    in vec4 aColor;
+    layout(location = 0) out vec4 vColor; 
+    layout(location = 1) out vec2 vLocal; 
+    void main() 
+    {
+        vColor = aColor;
+        vLocal = aPosition.xy;
+        gl_Position = uProjection * uModelview * aPosition;
+    });
+
+// Signed distance shapes. The texture coordinate carries the fragment position relative to
+// the shape center (in the same units as the geometry).
+// uParams[0] = (type, half width, half height, radius)
+// uParams[1] = (stroke, thickness, arc middle angle, arc half angle)
+// type 0: circle of radius, type 1: arc of radius, type 2: box of half width/height with
+// rounded corners of radius. Stroke draws a band of thickness inside the edge (at least one
+// pixel wide), arcs are always stroked. The color is vertex color * uColor.
+static const char* pShapeSdfFragShader = SHADER_GLSLV(
+    320, 
+    precision highp float; 
+    uniform vec4 uColor; 
+    uniform vec4 uParams[2]; 
+    layout(location = 0) in vec2 vLocal; 
+    layout(location = 1) in vec4 vColor;
+    layout(location = 0) out vec4 fragColor; 
+    void main(void) 
+    {
+        int type = int(uParams[0].x + 0.5);
+        float px = max(fwidth(vLocal.x), fwidth(vLocal.y));
+        float h = max(0.5 * uParams[1].y, 0.5 * px);
+        float d;
+        if (type == 0)
+        {
+            d = length(vLocal) - uParams[0].w;
+            if (uParams[1].x > 0.5)
+                d = abs(d + 0.5 * uParams[1].y) - h;
+        }
+        else if (type == 1)
+        {
+            float c = cos(uParams[1].z);
+            float s = sin(uParams[1].z);
+            vec2 q = vec2(c * vLocal.x + s * vLocal.y, abs(c * vLocal.y - s * vLocal.x));
+            float r = uParams[0].w - 0.5 * uParams[1].y;
+            if (atan(q.y, q.x) <= uParams[1].w)
+                d = abs(length(q) - r) - h;
+            else
+                d = length(q - r * vec2(cos(uParams[1].w), sin(uParams[1].w))) - h;
+        }
+        else
+        {
+            vec2 b = abs(vLocal) - uParams[0].yz + uParams[0].w;
+            d = length(max(b, 0.0)) + min(max(b.x, b.y), 0.0) - uParams[0].w;
+            if (uParams[1].x > 0.5)
+                d = abs(d + 0.5 * uParams[1].y) - h;
+        }
+        float coverage = clamp(0.5 - (d / px), 0.0, 1.0);
+        if (coverage <= 0.0)
+            discard;
+        vec4 color = vColor * uColor;
+        fragColor = vec4(color.rgb, color.a * coverage);
+    });
+
+static const char* pShapeSdfVertShader = SHADER_GLSLV(
+    320, 
+    precision highp float; 
+    uniform mat4 uModelview; 
+    uniform mat4 uProjection; 
+    layout(location = 0) in vec4 aPosition; 
+    layout(location = 1) in vec2 aLocal;
+    layout(location = 2) in vec4 aColor; 
+    layout(location = 0) out vec2 vLocal; 
+    layout(location = 1) out vec4 vColor; 
+    void main() 
+    {
+        vLocal = aLocal;
+        vColor = aColor;
+        gl_Position = uProjection * uModelview * aPosition;
     });
 
 ESShaderRepository& ESShaderRepository::Instance()
@@ -237,4 +388,7 @@ ESShaderRepository::ESShaderRepository()
     mShaders[COLOR_SPRITE] = compileShader(pColorSpriteFragShader, pColorSpriteVertShader);
     mShaders[FONT] = compileShader(pFontFragmentShader, pFontVertexShader);
     mShaders[COLOR_FILL] = compileShader(pColorFillFragShader, pColorFillVertShader);
+    mShaders[SHAPE_SDF] = compileShader(pShapeSdfFragShader, pShapeSdfVertShader);
+    mShaders[GRADIENT_FILL] = compileShader(pGradientFillFragShader, pGradientFillVertShader);
+    mShaders[FONT_SDF] = compileShader(pFontSdfFragmentShader, pFontVertexShader);
 }
@@ -28,10 +28,13 @@ public:
    //! @brief Shader IDs available
    enum ShaderID
    {
-      BASIC_SPRITE = 0,    //!< Basic textured shader. No colors.
-      COLOR_SPRITE,        //!< Textured shader with vertex colors.
-      FONT,                //!< Font shader.
-      COLOR_FILL,          //!< Untextured pixels, just vertex colors.
+      BASIC_SPRITE = 0,    //!< Basic textured shader. No vertex colors, texture * uColor.
+      COLOR_SPRITE,        //!< Textured shader with vertex colors * uColor.
+      FONT,                //!< Font shader, single channel coverage (red) * uColor.
+      COLOR_FILL,          //!< Untextured pixels, vertex colors * uColor.
+      SHAPE_SDF,           //!< Analytic shape on a quad (uParams), vertex colors * uColor.
+      GRADIENT_FILL,       //!< COLOR_FILL with a linear/radial gradient (uParams, ramp texture).
+      FONT_SDF,            //!< Font shader for distance field glyphs (red, edge at 0.5) * uColor.
       NUM_SHADERS          //!< Number of shaders available.
    };
 
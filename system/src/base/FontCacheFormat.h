@@ -0,0 +1,78 @@
+#pragma once
+#include <stdint.h>
+
+//! @brief Layout of the font cache files written by FontBaker and read by
+//! FontLibrary::LoadCache().
+//! @par A font cache holds fonts already rasterized by FreeType: the glyph metrics, the
+//! kerning pairs and the atlas pages, so the fonts are registered without opening a font
+//! file or rasterizing a glyph. The file is used in place through a memory mapping, every
+//! table is an array of fixed size, 4 byte aligned records in native byte order:
+//! FontCacheHeader, FontCacheFont[fontCount], then per font FontCacheGlyph[glyphCount]
+//! and FontCacheKerning[kerningCount], the string pool (zero terminated UTF-8 strings
+//! referenced by byte offset) and the atlas pages (pageSize * pageSize bytes each, single
+//! channel, rows top to bottom) uploaded as they are.
+namespace FontCacheFormat
+{
+   constexpr uint32_t MAGIC = 0x544E4647;  //!< "GFNT"
+   constexpr uint32_t VERSION = 1;
+   constexpr uint32_t PAGE_SIZE = 512;       //!< Atlas page width and height (GlyphAtlas)
+   constexpr uint32_t NO_PAGE = 0xFFFFFFFF;  //!< Glyph without pixels (space)
+
+   //! @brief Font flags
+   enum Flags : uint32_t
+   {
+      SDF = 0x01  //!< Distance field glyphs, FontLibrary::RegisterSdf()
+   };
+
+   struct FontCacheHeader
+   {
+      uint32_t magic;
+      uint32_t version;
+      uint32_t pageSize;      //!< PAGE_SIZE
+      uint32_t fontCount;
+      uint32_t fontOffset;    //!< Byte offset of the font table
+      uint32_t stringOffset;  //!< Byte offset of the string pool
+      uint32_t stringBytes;   //!< Size of the string pool
+      uint32_t reserved;
+   };
+
+   struct FontCacheFont
+   {
+      uint32_t name;           //!< String pool offset of the name it is registered as
+      uint32_t pointSize;
+      uint32_t height;         //!< Line height (in pixels)
+      int32_t ascender;        //!< 26.6 fixed point
+      int32_t descender;       //!< 26.6 fixed point, negative below the baseline
+      uint32_t flags;          //!< Flags
+      uint32_t glyphCount;
+      uint32_t glyphOffset;    //!< Byte offset of the glyphs, sorted by codepoint
+      uint32_t kerningCount;
+      uint32_t kerningOffset;  //!< Byte offset of the kerning pairs, sorted by pair
+      uint32_t pageCount;
+      uint32_t pageOffset;     //!< Byte offset of the first atlas page
+   };
+
+   struct FontCacheGlyph
+   {
+      uint32_t codepoint;
+      uint32_t index;          //!< FreeType glyph index (kerning pairs)
+      int32_t advance;         //!< 26.6 fixed point
+      int32_t height;          //!< 26.6 fixed point
+      int32_t bearingX;        //!< 26.6 fixed point
+      int32_t bearingY;        //!< 26.6 fixed point
+      uint16_t columns, rows;  //!< Bitmap size
+      uint32_t page;           //!< Atlas page or NO_PAGE
+      float u0, v0, u1, v1;    //!< Texture coordinates of the bitmap in the page
+   };
+
+   struct FontCacheKerning
+   {
+      uint32_t pair;  //!< Left glyph index << 16 | right glyph index
+      int32_t x;      //!< Pen adjustment, 26.6 fixed point
+   };
+
+   static_assert(sizeof(FontCacheHeader) == 32, "FontCacheHeader layout");
+   static_assert(sizeof(FontCacheFont) == 48, "FontCacheFont layout");
+   static_assert(sizeof(FontCacheGlyph) == 48, "FontCacheGlyph layout");
+   static_assert(sizeof(FontCacheKerning) == 8, "FontCacheKerning layout");
+}
@@ -2,27 +2,40 @@
 
 #include <ft2build.h>
 #include FT_FREETYPE_H
+#include FT_MODULE_H
+#include <algorithm>
+#include <deque>
 #include <stdint.h>
+#include <string.h>
 #include <string>
+#include <thread>
 
+#include "FontCacheFormat.h"
+#include "GlyphAtlas.h"
+#include "GlyphCache.h"
 #include "Log.h"
+#include "MappedFile.h"
 #include "utf8_utils.h"
 
-   static FT_Library library;
+   // opened by the first font loaded from a font file, fonts from a cache don't need it.
+   // Only used under the FontLibrary mutex, the rasterization workers open their own.
+   static FT_Library library = NULL;
+
+// FT_RENDER_MODE_SDF appeared in FreeType 2.11
+#if ((FREETYPE_MAJOR * 100) + FREETYPE_MINOR) >= 211
+#define FONT_SDF_SUPPORTED
+#endif
+
+   // Distance field range on each side of the glyph edges (pixels at the registered size)
+   static const int SDF_SPREAD = 8;
 
    class Glyph
    {
      public:
-      Glyph() : mpPixels(0) {}
-      ~Glyph()
-      {
-         if (mpPixels)
-         {
-            delete[] mpPixels;
-         }
-      }
+      Glyph() : pixelOffset(0), bInAtlas(false) {}
 
       uint32_t unicode;        //!< unicode value
+      uint32_t index;          //!< FreeType glyph index (kerning)
       uint32_t height;         //!< Height of this glyph
       uint32_t rows, columns;  //!< Row/Cols of bitmap data
       int32_t advance;         //!< Pixels to advance for this glyph
@@ -30,51 +43,93 @@
       int32_t ascender;        //!< Above baseline size
       int32_t horiBearingX;    //<! Positioning data
       int32_t horiBearingY;    //<! Positioning data
-      uint8_t* mpPixels;       //!< Pointer to pixels (In file, offset from data block)
+      uint32_t pixelOffset;    //!< Offset of the pixels in the font's bitmap arena
+      AtlasRegion region;      //!< Bitmap in the font atlas
+      bool bInAtlas;           //!< false for glyphs without pixels (space)
 
-      static Glyph* create(FT_Face face, uint32_t charcode)
+      //! @brief Rasterize a glyph
+      //! @param[in] face Font face
+      //! @param[in] charcode Codepoint
+      //! @param[out] glyph Metrics
+      //! @param[in,out] arena Bitmap arena, the rows * columns pixels are appended
+      //! @param[in] bSdf true for a distance field bitmap instead of coverage
+      //! @return bool true for success, false if the face has no glyph for charcode
+      static bool create(FT_Face face, uint32_t charcode, Glyph& glyph, std::vector<uint8_t>& arena,
+                         bool bSdf)
       {
-         Glyph* pGlyph = NULL;
          // Use freetype to generate the bitmap
          FT_UInt gindex = FT_Get_Char_Index(face, charcode);
-         if (gindex)
+         if (!gindex)
+         {
+            return false;
+         }
+#ifdef FONT_SDF_SUPPORTED
+         if (bSdf)
+         {
+            // unhinted outlines, the distance field is scaled to any size
+            FT_Load_Glyph(face, gindex, FT_LOAD_NO_HINTING);
+            FT_Render_Glyph(face->glyph, FT_RENDER_MODE_SDF);
+         }
+         else
+#endif
          {
             FT_Load_Glyph(face, gindex, FT_LOAD_DEFAULT);
             FT_Render_Glyph(face->glyph, FT_RENDER_MODE_NORMAL);
+         }
 
-            // build the output structure
-            pGlyph = new Glyph();
-            pGlyph->unicode = charcode;
-            pGlyph->columns = face->glyph->bitmap.width;
-            pGlyph->rows = face->glyph->bitmap.rows;
-            pGlyph->height = face->glyph->metrics.height;
-            pGlyph->advance = face->glyph->metrics.horiAdvance;
-            pGlyph->horiBearingX = face->glyph->metrics.horiBearingX;
-            pGlyph->decender = face->size->metrics.descender;
-            pGlyph->ascender = face->size->metrics.ascender;
-            pGlyph->horiBearingY = face->glyph->metrics.horiBearingY;
-            pGlyph->mpPixels = NULL;
-
-            if (face->glyph->bitmap.buffer != NULL)
+         // build the output structure
+         glyph.unicode = charcode;
+         glyph.index = gindex;
+         glyph.columns = face->glyph->bitmap.width;
+         glyph.rows = face->glyph->bitmap.rows;
+         glyph.height = face->glyph->metrics.height;
+         glyph.advance = face->glyph->metrics.horiAdvance;
+         glyph.horiBearingX = face->glyph->metrics.horiBearingX;
+         glyph.decender = face->size->metrics.descender;
+         glyph.ascender = face->size->metrics.ascender;
+         glyph.horiBearingY = face->glyph->metrics.horiBearingY;
+         glyph.pixelOffset = static_cast<uint32_t>(arena.size());
+         if (bSdf)
+         {
+            // the distance field extends past the outline by the spread
+            glyph.horiBearingX = face->glyph->bitmap_left * 64;
+            glyph.horiBearingY = face->glyph->bitmap_top * 64;
+         }
+
+         if (face->glyph->bitmap.buffer != NULL)
+         {
+            // copy bitmap (alpha only)
+            arena.resize(arena.size() + (glyph.columns * glyph.rows));
+            for (uint32_t y = 0; y < glyph.rows; y++)
             {
-               // copy bitmap (alpha only)
-               pGlyph->mpPixels = new uint8_t[pGlyph->columns * (pGlyph->rows)];
-               for (uint32_t y = 0; y < pGlyph->rows; y++)
-               {
-                  uint8_t* pOut = &pGlyph->mpPixels[(y * pGlyph->columns)];
-                  uint8_t* pIn = &face->glyph->bitmap.buffer[(y * face->glyph->bitmap.pitch)];
-                  memcpy(pOut, pIn, pGlyph->columns);
-               }
+               uint8_t* pOut = &arena[glyph.pixelOffset + (y * glyph.columns)];
+               uint8_t* pIn = &face->glyph->bitmap.buffer[(y * face->glyph->bitmap.pitch)];
+               memcpy(pOut, pIn, glyph.columns);
             }
          }
-         return pGlyph;
+         else
+         {
+            glyph.rows = glyph.columns = 0;
+         }
+         return true;
       }
    };
 
+   //! @brief Scale a face to a point size (96 dpi)
+   static FT_Error SetSize(FT_Face face, uint32_t pointSize)
+   {
+      return FT_Set_Char_Size(face,           /* handle to face object           */
+                              0,              /* char_width in 1/64th of points  */
+                              pointSize * 64, /* char_height in 1/64th of points */
+                              96,             /* horizontal device resolution    */
+                              96);            /* vertical device resolution      */
+   }
+
    class Font
    {
      public:
-      Font(uint32_t ps, const char* pFilename) : pointSize(ps), face(0), mHeight(0)
+      Font(uint32_t ps, const char* pFilename, bool bSdf)
+         : face(0), pointSize(ps), mHeight(0), mbKerning(false), mbSdf(bSdf), mFile(pFilename)
       {
          FT_Error error = FT_New_Face(library, pFilename, 0, &face);
          if (error != FT_Err_Ok)
@@ -83,91 +138,325 @@
             {
                //... the font file could be opened and read, but it appears
                //... that its font format is unsupported
-               log(Log::L_ERROR, "Unsupported font file\n");
+               addlog(Log::L_ERROR, "Unsupported font file\n");
             }
             else if (error)
             {
                //... another error code means that the font file could not
                //... be opened or read, or that it is broken...
-               log(Log::L_ERROR, "Error on font file\n");
+               addlog(Log::L_ERROR, "Error on font file\n");
             }
          }
          else
          {
-            error = FT_Set_Char_Size(face,           /* handle to face object           */
-                                     0,              /* char_width in 1/64th of points  */
-                                     pointSize * 64, /* char_height in 1/64th of points */
-                                     96,             /* horizontal device resolution    */
-                                     96);            /* vertical device resolution      */
+            error = SetSize(face, pointSize);
 
             // Save the height of the font for the renderer
             mHeight = (face->size->metrics.height >> 6);
+            mbKerning = FT_HAS_KERNING(face);
+         }
+      }
+      //! @brief Font from a font cache: glyphs, kerning and atlas pages baked by FontBaker
+      //! @param[in] baked Font record
+      //! @param[in] pData Mapped cache file, it must stay mapped until the atlas is uploaded
+      Font(const FontCacheFormat::FontCacheFont& baked, const uint8_t* pData)
+         : face(0), pointSize(baked.pointSize), mHeight(baked.height),
+           mbKerning(baked.kerningCount > 0), mbSdf((baked.flags & FontCacheFormat::SDF) != 0)
+      {
+         // the pages are uploaded from the mapping as they are
+         uint32_t firstPage = mAtlas.PageCount();
+         uint32_t pageBytes = FontCacheFormat::PAGE_SIZE * FontCacheFormat::PAGE_SIZE;
+         for (uint32_t i = 0; i < baked.pageCount; i++)
+         {
+            mAtlas.AddPage(pData + baked.pageOffset + (i * pageBytes));
+         }
+
+         const FontCacheFormat::FontCacheGlyph* pGlyphs =
+            reinterpret_cast<const FontCacheFormat::FontCacheGlyph*>(pData + baked.glyphOffset);
+         for (uint32_t i = 0; i < baked.glyphCount; i++)
+         {
+            const FontCacheFormat::FontCacheGlyph& g = pGlyphs[i];
+            Glyph glyph;
+            glyph.unicode = g.codepoint;
+            glyph.index = g.index;
+            glyph.height = g.height;
+            glyph.rows = g.rows;
+            glyph.columns = g.columns;
+            glyph.advance = g.advance;
+            glyph.decender = baked.descender;
+            glyph.ascender = baked.ascender;
+            glyph.horiBearingX = g.bearingX;
+            glyph.horiBearingY = g.bearingY;
+            if ((g.page != FontCacheFormat::NO_PAGE) && (g.page < baked.pageCount))
+            {
+               glyph.bInAtlas = true;
+               glyph.region.page = firstPage + g.page;
+               glyph.region.u0 = g.u0;
+               glyph.region.v0 = g.v0;
+               glyph.region.u1 = g.u1;
+               glyph.region.v1 = g.v1;
+            }
+            mGlyphs.push_back(glyph);
+            mCache.Insert(g.codepoint, static_cast<int32_t>(mGlyphs.size() - 1));
          }
+
+         const FontCacheFormat::FontCacheKerning* pKerning =
+            reinterpret_cast<const FontCacheFormat::FontCacheKerning*>(pData + baked.kerningOffset);
+         mKerning.assign(pKerning, pKerning + baked.kerningCount);
       }
       virtual ~Font()
       {
-         // delete all cached glyphs
-         while (mGlyphs.begin() != mGlyphs.end())
+         if (face)
          {
-            delete (*mGlyphs.begin()).second;
-            mGlyphs.erase(mGlyphs.begin());
+            FT_Done_Face(face);
          }
-         FT_Done_Face(face);
       }
 
-      const Glyph* GetChar(uint32_t unicode)
+      //! @brief Glyph id of a codepoint, the glyph is rasterized if needed
+      //! @return Glyph id, GlyphCache::MISSING if the font has no glyph for it
+      int32_t GetId(uint32_t unicode)
       {
-         Glyph* pRet = 0;
-         std::map<uint32_t, Glyph*>::iterator it = mGlyphs.find(unicode);
-         if (it == mGlyphs.end())
+         int32_t index = mCache.Find(unicode);
+         if (index == GlyphCache::NOT_LOADED)
          {
             // not found in cache, build it
-            pRet = Glyph::create(face, unicode);
-            if (pRet)
+            index = Load(unicode);
+            mCache.Insert(unicode, index);
+         }
+         return index;
+      }
+
+      const Glyph* GetChar(uint32_t unicode)
+      {
+         int32_t index = GetId(unicode);
+         return (index >= 0) ? &mGlyphs[index] : NULL;
+      }
+
+      const Glyph& GetGlyph(uint32_t id) const { return mGlyphs[id]; }
+
+      //! @brief Kerning between two glyphs
+      //! @return Pen adjustment (26.6 fixed point pixels)
+      int32_t Kerning(const Glyph& left, const Glyph& right) const
+      {
+         if (!mKerning.empty())
+         {
+            // baked pairs, sorted
+            FontCacheFormat::FontCacheKerning key = {(left.index << 16) | right.index, 0};
+            std::vector<FontCacheFormat::FontCacheKerning>::const_iterator it = std::lower_bound(
+               mKerning.begin(), mKerning.end(), key,
+               [](const FontCacheFormat::FontCacheKerning& a,
+                  const FontCacheFormat::FontCacheKerning& b) { return a.pair < b.pair; });
+            return ((it != mKerning.end()) && ((*it).pair == key.pair)) ? (*it).x : 0;
+         }
+         FT_Vector delta;
+         if (mbKerning && face &&
+             (FT_Get_Kerning(face, left.index, right.index, FT_KERNING_DEFAULT, &delta) == 0))
+         {
+            return static_cast<int32_t>(delta.x);
+         }
+         return 0;
+      }
+
+      //! @brief Rasterize a range of codepoints ahead of use
+      void Preload(uint32_t first, uint32_t last)
+      {
+         for (uint32_t c = first; c <= last; c++)
+         {
+            GetChar(c);
+         }
+      }
+
+      //! @brief Add the codepoints of a string that are not cached yet to a set
+      void Uncached(const char* pString, std::vector<uint32_t>& codepoints) const
+      {
+         std::string str = pString;
+         Utf8::Utf8Iterator sit(str.begin());
+         while (sit != str.end())
+         {
+            if (mCache.Find(*sit) == GlyphCache::NOT_LOADED)
             {
-               mGlyphs[unicode] = pRet;
-               // update any metrics here
+               codepoints.push_back(*sit);
             }
+            ++sit;
          }
-         else
+      }
+
+      //! @brief Cache a glyph rasterized with another face of the same font
+      //! @param[in] glyph Metrics, pixelOffset in the arena of pPixels
+      //! @param[in] pArena Bitmap arena of the glyph
+      void Adopt(const Glyph& glyph, const uint8_t* pArena)
+      {
+         if (mCache.Find(glyph.unicode) != GlyphCache::NOT_LOADED)
          {
-            // found in the cache, just return it
-            pRet = (*it).second;
+            return;  // loaded on demand in the meantime
          }
+         Glyph copy = glyph;
+         copy.pixelOffset = static_cast<uint32_t>(mBitmaps.size());
+         const uint8_t* pPixels = pArena + glyph.pixelOffset;
+         mBitmaps.insert(mBitmaps.end(), pPixels, pPixels + (glyph.columns * glyph.rows));
+         mCache.Insert(glyph.unicode, Store(copy));
+      }
 
-         return pRet;
+      //! @brief Cache a codepoint the font has no glyph for
+      void AdoptMissing(uint32_t unicode)
+      {
+         if (mCache.Find(unicode) == GlyphCache::NOT_LOADED)
+         {
+            mCache.Insert(unicode, GlyphCache::MISSING);
+         }
       }
+
+      //! @brief Bitmap of a glyph (rows * columns coverage bytes)
+      const uint8_t* Pixels(const Glyph& glyph) const { return &mBitmaps[glyph.pixelOffset]; }
+
       uint32_t Height() const { return mHeight; }
+      uint32_t PointSize() const { return pointSize; }
+      bool IsSdf() const { return mbSdf; }
+      //! @brief true if the font file is open in FreeType (never for a baked font)
+      bool IsLoaded() const { return face != 0; }
+      //! @brief Font file, empty for a baked font
+      const std::string& File() const { return mFile; }
+      GlyphAtlas& Atlas() { return mAtlas; }
      private:
       FT_Face face;
       uint32_t pointSize;
       uint32_t mHeight;
+      bool mbKerning;  //!< The face has a kerning table
+      bool mbSdf;      //!< Distance field glyphs (FONT_SDF shader)
+      std::string mFile;
+
+      //! @brief Rasterize a glyph into the cache
+      //! @return Glyph index, GlyphCache::MISSING if the font has no glyph for it
+      int32_t Load(uint32_t unicode)
+      {
+         Glyph glyph;
+         if (!face || !Glyph::create(face, unicode, glyph, mBitmaps, mbSdf))
+         {
+            return GlyphCache::MISSING;
+         }
+         return Store(glyph);
+      }
 
-      std::map<uint32_t, Glyph*> mGlyphs;
+      //! @brief Pack a glyph (bitmap in mBitmaps) into the atlas and keep it
+      //! @return Glyph index
+      int32_t Store(Glyph& glyph)
+      {
+         if (glyph.rows > 0)
+         {
+            glyph.bInAtlas = mAtlas.Add(Pixels(glyph), glyph.columns, glyph.rows, glyph.region);
+         }
+         mGlyphs.push_back(glyph);
+         return static_cast<int32_t>(mGlyphs.size() - 1);
+      }
+
+      GlyphCache mCache;
+      std::deque<Glyph> mGlyphs;      //!< Glyph records, a deque keeps them in place
+      std::vector<uint8_t> mBitmaps;  //!< All glyph bitmaps, back to back
+      GlyphAtlas mAtlas;
+      std::vector<FontCacheFormat::FontCacheKerning> mKerning;  //!< Pairs of a baked font
    };
 
-   static std::map<std::string, Font*> mFonts;
+   //! @brief Open a FreeType library with the renderer settings of the fonts
+   static FT_Error OpenLibrary(FT_Library& lib)
+   {
+      FT_Error error = FT_Init_FreeType(&lib);
+      if (error)
+      {
+         lib = NULL;
+         return error;
+      }
+#ifdef FONT_SDF_SUPPORTED
+      // wider than the default (2) so the glyphs can be magnified
+      FT_Int spread = SDF_SPREAD;
+      FT_Property_Set(lib, "sdf", "spread", &spread);
+      FT_Property_Set(lib, "bsdf", "spread", &spread);
+#endif
+      return error;
+   }
 
-   FontLibrary::FontLibrary()
+   //! @brief Open FreeType on first use
+   //! @return bool true if the library is ready
+   static bool InitFreeType()
    {
-      // Open FreeType
-      FT_Error error = FT_Init_FreeType(&library);
+      if (library)
+      {
+         return true;
+      }
+      FT_Error error = OpenLibrary(library);
       if (error)
       {
          // Error
-         log(Log::L_ERROR, "Failed to init freetype library (%d)\n", error);
+         addlog(Log::L_ERROR, "Failed to init freetype library (%d)\n", error);
+         return false;
       }
+      return true;
+   }
+
+   //! @brief Codepoints for one rasterization worker, and its results
+   struct RasterJob
+   {
+      const Font* pFont;
+      const uint32_t* pCodepoints;
+      size_t count;
+      std::vector<Glyph> glyphs;
+      std::vector<uint8_t> arena;    //!< Bitmaps of glyphs
+      std::vector<uint32_t> missing;  //!< Codepoints the font has no glyph for
+      bool bDone;                     //!< false if the font could not be opened
+   };
+
+   //! @brief Worker: rasterize with a FreeType library and face of its own, FreeType
+   //! objects are not shared between threads
+   static void Rasterize(RasterJob* pJob)
+   {
+      pJob->bDone = false;
+      FT_Library lib;
+      if (OpenLibrary(lib) != 0)
+      {
+         return;
+      }
+      FT_Face face;
+      if ((FT_New_Face(lib, pJob->pFont->File().c_str(), 0, &face) == 0))
+      {
+         SetSize(face, pJob->pFont->PointSize());
+         for (size_t i = 0; i < pJob->count; i++)
+         {
+            Glyph glyph;
+            if (Glyph::create(face, pJob->pCodepoints[i], glyph, pJob->arena, pJob->pFont->IsSdf()))
+            {
+               pJob->glyphs.push_back(glyph);
+            }
+            else
+            {
+               pJob->missing.push_back(pJob->pCodepoints[i]);
+            }
+         }
+         FT_Done_Face(face);
+         pJob->bDone = true;
+      }
+      FT_Done_FreeType(lib);
+   }
+
+   FontLibrary::FontLibrary()
+   {
    }
 
    FontLibrary::~FontLibrary()
    {
       // Release all the loaded fonts
-      while (mFonts.begin() != mFonts.end())
+      for (Font* pFont : mFonts)
+      {
+         delete pFont;
+      }
+      mFonts.clear();
+      mNames.clear();
+      for (MappedFile* pFile : mCacheFiles)
+      {
+         delete pFile;
+      }
+      if (library)
       {
-         delete ((*mFonts.begin()).second);
-         mFonts.erase(mFonts.begin());
+         FT_Done_FreeType(library);
       }
-      FT_Done_FreeType(library);
    }
 
    FontLibrary& FontLibrary::instance()
@@ -177,114 +466,343 @@
       return fl;
    }
 
-   bool FontLibrary::Register(const char* pFontName, const char* pFontFile, uint32_t pointSize)
+   FontHandle FontLibrary::Register(const char* pFontName, const char* pFontFile,
+                                    uint32_t pointSize)
    {
-      bool bLoaded = false;
-      std::map<std::string, Font*>::iterator it = mFonts.find(pFontName);
-      if (it == mFonts.end())
+      // printable ASCII
+      static const CodepointRange ascii = {32, 126};
+      return Register(pFontName, pFontFile, pointSize, &ascii, 1);
+   }
+
+   FontHandle FontLibrary::Register(const char* pFontName, const char* pFontFile,
+                                    uint32_t pointSize, const CodepointRange* pPreload,
+                                    uint32_t preloadCount)
+   {
+      return Add(pFontName, pFontFile, pointSize, false, pPreload, preloadCount);
+   }
+
+   FontHandle FontLibrary::RegisterSdf(const char* pFontName, const char* pFontFile,
+                                       uint32_t pointSize)
+   {
+#ifdef FONT_SDF_SUPPORTED
+      // printable ASCII
+      static const CodepointRange ascii = {32, 126};
+      return Add(pFontName, pFontFile, pointSize, true, &ascii, 1);
+#else
+      addlog(Log::L_ERROR, "Distance field fonts need FreeType 2.11 (%s)\n", pFontName);
+      return NO_FONT;
+#endif
+   }
+
+   FontHandle FontLibrary::Find(const char* pFontName)
+   {
+      std::lock_guard<std::mutex> lock(mMutex);
+      std::map<std::string, FontHandle>::const_iterator it = mNames.find(pFontName);
+      if (it == mNames.end())
       {
-         Font* pFont = new Font(pointSize, pFontFile);
-         mFonts[pFontName] = pFont;
-         // TODO: Pre-load common chars...
-         pFont->GetChar(32);  // Cache the space char
-         bLoaded = true;
+         addlog(Log::L_ERROR, "Unknown font (%s)\n", pFontName);
+         return NO_FONT;
       }
-      return bLoaded;
+      return (*it).second;
    }
 
-   uint8_t* FontLibrary::Render(const char* pString, const char* pFontName, uint32_t& w,
-                                uint32_t& h)
+   Font* FontLibrary::Get(FontHandle font) const
    {
-      uint8_t* pPixels = 0;
+      if ((font == NO_FONT) || (font > mFonts.size()))
+      {
+         addlog(Log::L_ERROR, "Unknown font (%u)\n", font);
+         return NULL;
+      }
+      return mFonts[font - 1];
+   }
 
-      // Get the requested font
-      Font* pFont = mFonts[pFontName];
-      if (pFont)
+   bool FontLibrary::IsSdf(FontHandle font)
+   {
+      std::lock_guard<std::mutex> lock(mMutex);
+      const Font* pFont = Get(font);
+      return pFont && pFont->IsSdf();
+   }
+
+   FontHandle FontLibrary::Add(const char* pFontName, const char* pFontFile, uint32_t pointSize,
+                               bool bSdf, const CodepointRange* pPreload, uint32_t preloadCount)
+   {
+      std::lock_guard<std::mutex> lock(mMutex);
+      if (mNames.find(pFontName) != mNames.end())
+      {
+         addlog(Log::L_ERROR, "Font %s already registered\n", pFontName);
+         return NO_FONT;
+      }
+      if (!InitFreeType())
       {
-         w = 0;
-         h = pFont->Height();
+         return NO_FONT;
+      }
+      Font* pFont = new Font(pointSize, pFontFile, bSdf);
+      if (!pFont->IsLoaded())
+      {
+         addlog(Log::L_ERROR, "Font %s not registered, can't load %s\n", pFontName, pFontFile);
+         delete pFont;
+         return NO_FONT;
+      }
+      mFonts.push_back(pFont);
+      FontHandle handle = static_cast<FontHandle>(mFonts.size());
+      mNames[pFontName] = handle;
+      for (uint32_t i = 0; i < preloadCount; i++)
+      {
+         pFont->Preload(pPreload[i].first, pPreload[i].last);
+      }
+      return handle;
+   }
 
-         // gather the required glyphs and generate the width
-         std::list<const Glyph*> lGlyphs;
-         std::string str = pString;
-         // Use UTF-8 codepoints instead of ASCII chars
-         Utf8::Utf8Iterator sit(str.begin());
-         while (sit != str.end())
+   bool FontLibrary::LoadCache(const char* pCacheFile)
+   {
+      using namespace FontCacheFormat;
+
+      MappedFile* pFile = new MappedFile();
+      if (!pFile->Open(pCacheFile))
+      {
+         delete pFile;
+         return false;
+      }
+      const uint8_t* pData = pFile->Data();
+      size_t size = pFile->Size();
+      const FontCacheHeader* pHeader = reinterpret_cast<const FontCacheHeader*>(pData);
+      if ((size < sizeof(FontCacheHeader)) || (pHeader->magic != MAGIC) ||
+          (pHeader->version != VERSION) || (pHeader->pageSize != PAGE_SIZE) ||
+          ((pHeader->fontOffset + (uint64_t(pHeader->fontCount) * sizeof(FontCacheFont))) > size) ||
+          ((pHeader->stringOffset + uint64_t(pHeader->stringBytes)) > size) ||
+          (pHeader->stringBytes == 0) ||
+          (pData[pHeader->stringOffset + pHeader->stringBytes - 1] != 0))
+      {
+         addlog(Log::L_ERROR, "Invalid font cache %s\n", pCacheFile);
+         delete pFile;
+         return false;
+      }
+
+      // check every table before registering anything
+      const FontCacheFont* pFonts =
+         reinterpret_cast<const FontCacheFont*>(pData + pHeader->fontOffset);
+      const uint64_t pageBytes = uint64_t(PAGE_SIZE) * PAGE_SIZE;
+      for (uint32_t i = 0; i < pHeader->fontCount; i++)
+      {
+         const FontCacheFont& f = pFonts[i];
+         if ((f.name >= pHeader->stringBytes) ||
+             ((f.glyphOffset + (uint64_t(f.glyphCount) * sizeof(FontCacheGlyph))) > size) ||
+             ((f.kerningOffset + (uint64_t(f.kerningCount) * sizeof(FontCacheKerning))) > size) ||
+             ((f.pageOffset + (f.pageCount * pageBytes)) > size))
          {
-            const Glyph* pGlyph = pFont->GetChar(*sit);
-            if (pGlyph)
-            {
-               lGlyphs.push_back(pGlyph);
-               w += (pGlyph->advance >> 6);
-            }
-            else
-            {
-               log(Log::L_ERROR, "Unsupported code point (%x)\n", (*sit));
-            }
-            ++sit;
+            addlog(Log::L_ERROR, "Invalid font cache %s\n", pCacheFile);
+            delete pFile;
+            return false;
+         }
+      }
+
+      const char* pStrings = reinterpret_cast<const char*>(pData + pHeader->stringOffset);
+      std::lock_guard<std::mutex> lock(mMutex);
+      for (uint32_t i = 0; i < pHeader->fontCount; i++)
+      {
+         const char* pName = pStrings + pFonts[i].name;
+         if (mNames.find(pName) != mNames.end())
+         {
+            addlog(Log::L_ERROR, "Font %s already registered, not loaded from %s\n", pName,
+                   pCacheFile);
+            continue;
+         }
+         mFonts.push_back(new Font(pFonts[i], pData));
+         mNames[pName] = static_cast<FontHandle>(mFonts.size());
+      }
+      // the atlas pages are read from the mapping by their first upload
+      mCacheFiles.push_back(pFile);
+      return true;
+   }
+
+   bool FontLibrary::Prerasterize(FontHandle font, const char* const* ppStrings, uint32_t count,
+                                  uint32_t threads)
+   {
+      Font* pFont = NULL;
+      std::vector<uint32_t> codepoints;
+      {
+         std::lock_guard<std::mutex> lock(mMutex);
+         pFont = Get(font);
+         if (!pFont)
+         {
+            return false;
+         }
+         if (pFont->File().empty())
+         {
+            return true;  // baked, nothing more to rasterize
+         }
+         for (uint32_t i = 0; i < count; i++)
+         {
+            pFont->Uncached(ppStrings[i], codepoints);
+         }
+      }
+      std::sort(codepoints.begin(), codepoints.end());
+      codepoints.erase(std::unique(codepoints.begin(), codepoints.end()), codepoints.end());
+      if (codepoints.empty())
+      {
+         return true;
+      }
+
+      // a worker opens a library and a face, give it a few dozen glyphs at least
+      if (threads == 0)
+      {
+         threads = std::max(1u, std::thread::hardware_concurrency());
+      }
+      const size_t MIN_GLYPHS_PER_THREAD = 32;
+      size_t workers = std::min<size_t>(threads, 1 + (codepoints.size() / MIN_GLYPHS_PER_THREAD));
+      size_t chunk = (codepoints.size() + workers - 1) / workers;
+      std::vector<RasterJob> jobs(workers);
+      for (size_t i = 0; i < workers; i++)
+      {
+         size_t first = std::min(i * chunk, codepoints.size());
+         jobs[i].pFont = pFont;
+         jobs[i].pCodepoints = codepoints.data() + first;
+         jobs[i].count = std::min(chunk, codepoints.size() - first);
+      }
+
+      // the calling thread takes the first job, the library stays usable meanwhile
+      std::vector<std::thread> pool;
+      for (size_t i = 1; i < workers; i++)
+      {
+         pool.emplace_back(Rasterize, &jobs[i]);
+      }
+      Rasterize(&jobs[0]);
+      for (std::thread& t : pool)
+      {
+         t.join();
+      }
+
+      // pack the bitmaps, they are uploaded by the next AtlasTexture() on the GL thread
+      std::lock_guard<std::mutex> lock(mMutex);
+      bool bOk = true;
+      for (const RasterJob& job : jobs)
+      {
+         for (const Glyph& glyph : job.glyphs)
+         {
+            pFont->Adopt(glyph, job.arena.data());
+         }
+         for (uint32_t unicode : job.missing)
+         {
+            pFont->AdoptMissing(unicode);
          }
+         bOk = bOk && job.bDone;
+      }
+      if (!bOk)
+      {
+         addlog(Log::L_ERROR, "Failed to open %s for rasterization\n", pFont->File().c_str());
+      }
+      return bOk;
+   }
+
+   bool FontLibrary::Layout(const char* pString, FontHandle font, GlyphRun& run)
+   {
+      std::lock_guard<std::mutex> lock(mMutex);
+      run.glyphs.clear();
+      run.w = 0;
+      run.h = 0;
+
+      // Get the requested font
+      Font* pFont = Get(font);
+      if (!pFont)
+      {
+         return false;
+      }
+      run.h = pFont->Height();
 
-         if (w > 0)
+      // pen position in 26.6 fixed point, rounded to pixels only when drawn
+      int32_t pen = 0;
+      const Glyph* pPrevious = NULL;
+      std::string str = pString;
+      // Use UTF-8 codepoints instead of ASCII chars
+      Utf8::Utf8Iterator sit(str.begin());
+      while (sit != str.end())
+      {
+         int32_t id = pFont->GetId(*sit);
+         if (id >= 0)
          {
-            // allocate the pixel data
-            // output in RGBA format with all components set to the 8 bit alpha from the glyph
-            size_t bufSize = w * h * 4;
-            pPixels = new uint8_t[bufSize];
-            if (pPixels)
+            const Glyph& glyph = pFont->GetGlyph(id);
+            if (pPrevious)
             {
-               memset(pPixels, 0, bufSize);
-
-               // copy each glyph to the buffer in place
-               uint32_t x = 0;
-               std::list<const Glyph*>::iterator it = lGlyphs.begin();
-               while (it != lGlyphs.end())
-               {
-                  const Glyph* pGlyph = (*it);
-                  // adjust the position in the output texture for glyph metrics
-                  // Note: decender is expressed in negative values (from baseline)
-                  //       Both decender and bearings are in 26.6 fixed point formats
-                  uint32_t oy = h + (pGlyph->decender >> 6) - (pGlyph->horiBearingY >> 6);
-                  uint32_t ox = x + (pGlyph->horiBearingX >> 6);
-                  for (uint32_t y = 0; y < pGlyph->rows; y++)
-                  {
-                     // point to the start of the input scanline
-                     uint8_t* pIn = &pGlyph->mpPixels[y * pGlyph->columns];
-                     // point to the start of the output rectangle
-                     uint8_t* pOut = &pPixels[((oy + y) * w * 4) + (ox * 4)];
-                     for (uint32_t i = 0; i < pGlyph->columns; i++)
-                     {
-                        // Store the 8 bit alpha value in all 4 color components
-                        *pOut++ = *pIn;
-                        *pOut++ = *pIn;
-                        *pOut++ = *pIn;
-                        *pOut++ = *pIn++;
-                     }
-                  }
-                  // Move x to the next char horiz. baseline, advance is in 26.6 fixed point format
-                  x += (pGlyph->advance >> 6);
-                  ++it;
-               }
+               pen += pFont->Kerning(*pPrevious, glyph);
             }
+            GlyphPosition position;
+            position.glyph = static_cast<uint32_t>(id);
+            position.codepoint = *sit;
+            position.x = pen;
+            run.glyphs.push_back(position);
+            pen += glyph.advance;
+            pPrevious = &glyph;
          }
          else
          {
-            log(Log::L_INFO, "No data for String Render\n");
+            addlog(Log::L_ERROR, "Unsupported code point (%x)\n", (*sit));
          }
+         ++sit;
       }
-      else
+      run.w = (pen > 0) ? static_cast<uint32_t>((pen + 63) >> 6) : 0;
+      return true;
+   }
+
+   bool FontLibrary::BuildQuads(const GlyphRun& run, FontHandle font,
+                                std::vector<GlyphQuad>& quads)
+   {
+      std::lock_guard<std::mutex> lock(mMutex);
+      quads.clear();
+      const Font* pFont = Get(font);
+      if (!pFont)
       {
-         log(Log::L_ERROR, "Memory Allocation error in Font Render\n");
+         return false;
       }
+      int32_t h = static_cast<int32_t>(pFont->Height());
 
-      return pPixels;
+      for (const GlyphPosition& position : run.glyphs)
+      {
+         const Glyph& glyph = pFont->GetGlyph(position.glyph);
+         if (!glyph.bInAtlas)
+         {
+            continue;  // no pixels (space)
+         }
+         // adjust the position for glyph metrics, the pen is rounded to a whole pixel
+         // Note: decender is expressed in negative values (from baseline)
+         //       Pen, decender and bearings are in 26.6 fixed point formats
+         GlyphQuad q;
+         q.x0 = static_cast<float>(((position.x + 32) >> 6) + (glyph.horiBearingX >> 6));
+         q.y0 = static_cast<float>(h + (glyph.decender >> 6) - (glyph.horiBearingY >> 6));
+         q.x1 = q.x0 + glyph.columns;
+         q.y1 = q.y0 + glyph.rows;
+         q.u0 = glyph.region.u0;
+         q.v0 = glyph.region.v0;
+         q.u1 = glyph.region.u1;
+         q.v1 = glyph.region.v1;
+         q.page = glyph.region.page;
+         quads.push_back(q);
+      }
+      return true;
+   }
+
+   bool FontLibrary::BuildQuads(const char* pString, FontHandle font,
+                                std::vector<GlyphQuad>& quads, uint32_t& w, uint32_t& h)
+   {
+      GlyphRun run;
+      bool bOk = Layout(pString, font, run) && BuildQuads(run, font, quads);
+      w = run.w;
+      h = run.h;
+      return bOk;
    }
 
+   uint32_t FontLibrary::AtlasTexture(FontHandle font, uint32_t page)
+   {
+      std::lock_guard<std::mutex> lock(mMutex);
+      Font* pFont = Get(font);
+      return pFont ? pFont->Atlas().Texture(page) : 0;
+   }
 
-   int32_t FontLibrary::CharWidth(const char* pFontName, uint32_t codepoint)
+   int32_t FontLibrary::CharWidth(FontHandle font, uint32_t codepoint)
    {
+      std::lock_guard<std::mutex> lock(mMutex);
       int32_t iRet = 0;
       // Get the requested font
-      Font* pFont = mFonts[pFontName];
+      Font* pFont = Get(font);
       if (pFont)
       {
          const Glyph* pGlyph = pFont->GetChar(codepoint);
@@ -1,16 +1,56 @@
 #ifndef __FONT_LIBRARY_H__
 #define __FONT_LIBRARY_H__
 
-#include <list>
 #include <map>
+#include <mutex>
 #include <string>
 #include <stdint.h>
+#include <vector>
 
 
    class Font;
+   class MappedFile;
+
+   //! @brief A registered font, see FontLibrary::Register() and Find(). Fonts are looked up
+   //! by name once, the text calls take the handle. 0 (NO_FONT) is no font, so a handle
+   //! tests as a bool.
+   typedef uint32_t FontHandle;
+   const FontHandle NO_FONT = 0;
+
+   //! @brief Inclusive range of codepoints, see FontLibrary::Register()
+   struct CodepointRange
+   {
+      uint32_t first;
+      uint32_t last;
+   };
+
+   //! @brief A glyph placed on the baseline of a laid out string.
+   struct GlyphPosition
+   {
+      uint32_t glyph;      //!< Glyph id in the font
+      uint32_t codepoint;  //!< Character shown (line breaking)
+      int32_t x;           //!< Pen position (26.6 fixed point pixels), kerning applied
+   };
+
+   //! @brief A laid out string: glyphs and their positions, independent of the pixels.
+   struct GlyphRun
+   {
+      std::vector<GlyphPosition> glyphs;  //!< One per codepoint the font has
+      uint32_t w, h;                      //!< Size of the text (in pixels)
+   };
+
+   //! @brief One glyph of a laid out string, drawn from the font's atlas.
+   struct GlyphQuad
+   {
+      float x0, y0, x1, y1;  //!< Rectangle in pixels from the upper left of the text, y down
+      float u0, v0, u1, v1;  //!< Texture coordinates in the atlas page
+      uint32_t page;         //!< Atlas page, see FontLibrary::AtlasTexture()
+   };
 
    //! @brief Contains/Parses/Draws Text
    //! @par Classic Singleton pattern
+   //! @par Thread safe: the calls are serialized by a mutex (the texture calls still need
+   //! the GL thread), Prerasterize() rasterizes in parallel outside of it.
    class FontLibrary
    {
      private:
@@ -22,27 +62,108 @@
       //! @return reference to the singleton instance
       static FontLibrary& instance();
 
-      //! @brief Register a font
+      //! @brief Register a font, preloading the printable ASCII glyphs
+      //! @param[in] pFontName Name of the new font
+      //! @param[in] pFontFile Name of the file to load (freetype supported formats)
+      //! @param[in] pointSize font point size to create
+      //! @return FontHandle The font, NO_FONT for fail (error in log)
+      FontHandle Register(const char* pFontName, const char* pFontFile, uint32_t pointSize);
+
+      //! @brief Register a font, preloading the given codepoint ranges
+      //! @par Preloaded glyphs are rasterized and packed now (no GL context needed), other
+      //! glyphs the first time they are used.
       //! @param[in] pFontName Name of the new font
       //! @param[in] pFontFile Name of the file to load (freetype supported formats)
       //! @param[in] pointSize font point size to create
+      //! @param[in] pPreload Ranges to preload
+      //! @param[in] preloadCount Number of ranges (0 for none)
+      //! @return FontHandle The font, NO_FONT for fail (error in log)
+      FontHandle Register(const char* pFontName, const char* pFontFile, uint32_t pointSize,
+                          const CodepointRange* pPreload, uint32_t preloadCount);
+
+      //! @brief Register a distance field font: the glyphs are rasterized once at pointSize
+      //! as signed distance fields (FreeType 2.11 or newer) and drawn with the FONT_SDF
+      //! shader, sharp at any scale. A single registration serves every size, the text is
+      //! scaled by its screen rectangle or transform. Preloads the printable ASCII glyphs.
+      //! @param[in] pFontName Name of the new font
+      //! @param[in] pFontFile Name of the file to load (freetype supported formats)
+      //! @param[in] pointSize Point size of the distance fields (the layout size)
+      //! @return FontHandle The font, NO_FONT for fail (error in log)
+      FontHandle RegisterSdf(const char* pFontName, const char* pFontFile, uint32_t pointSize);
+
+      //! @brief Handle of a registered font (setup time, the name is looked up)
+      //! @param[in] pFontName Name the font was registered as
+      //! @return FontHandle The font, NO_FONT for an unknown name (error in log)
+      FontHandle Find(const char* pFontName);
+
+      //! @brief true if the font was registered with RegisterSdf() (FONT_SDF shader)
+      bool IsSdf(FontHandle font);
+
+      //! @brief Register the fonts of a font cache baked by FontBaker (see FontCacheFormat.h)
+      //! @par The file is memory mapped: the glyph metrics and kerning pairs are read from
+      //! it and the atlas pages uploaded from it as they are, nothing is rasterized and
+      //! FreeType is not opened. The fonts only have the glyphs that were baked, other
+      //! codepoints are missing. Their handles are given by Find().
+      //! @param[in] pCacheFile Font cache file
       //! @return bool true for success, false for fail (error in log)
-      bool Register(const char* pFontName, const char* pFontFile, uint32_t pointSize);
+      bool LoadCache(const char* pCacheFile);
+
+      //! @brief Rasterize the glyphs of a set of strings ahead of use, across threads
+      //! @par Each worker opens its own FreeType library and face (FreeType objects are not
+      //! thread safe), the library is not locked while they run. The bitmaps are packed
+      //! into the font's atlas when they are done and uploaded by the next AtlasTexture()
+      //! call on the GL thread, so a screen loader can call this from a loading thread
+      //! while other work (image decoding) goes on.
+      //! @param[in] font Registered font
+      //! @param[in] ppStrings UTF-8 strings
+      //! @param[in] count Number of strings
+      //! @param[in] threads Maximum number of threads (0 for one per hardware thread), the
+      //! calling thread is one of them
+      //! @return bool true for success, false for an unknown font or a font file that can't
+      //! be opened (error in log)
+      bool Prerasterize(FontHandle font, const char* const* ppStrings, uint32_t count,
+                        uint32_t threads = 0);
+
+      //! @brief Lay out a string: glyph ids and pen positions, with the font's kerning
+      //! @param[in] pString UTF-8 string to lay out
+      //! @param[in] font Registered font
+      //! @param[out] run Laid out glyphs (replaced)
+      //! @return bool true for success, false for an unknown font (error in log)
+      bool Layout(const char* pString, FontHandle font, GlyphRun& run);
 
-      //! @brief Render a string in the given font for the FONT shader to draw
-      //! @return pointer to pixels, may be NULL if error (logged)
-      //! @param[in] pString UTF-8 string to render
-      //! @param[in] pFontName Name of the previously Registered font
-      //! @param[out] w Width of the returned texture (in pixels)
-      //! @param[out] h Height of the returned texture (in pixels)
-      //! @par Note: Caller must delete[] the returned pointer
-      uint8_t* Render(const char* pString, const char* pFontName, uint32_t& w, uint32_t& h);
+      //! @brief Turn a laid out string into one quad per glyph for the FONT shader
+      //! @par Glyphs are rasterized into the font's atlas the first time they are used, the
+      //! quads only reference them: no texture is created or uploaded per string.
+      //! @param[in] run Glyphs from Layout() with the same font
+      //! @param[in] font Registered font
+      //! @param[out] quads Glyph quads (replaced), glyphs without pixels (spaces) are skipped
+      //! @return bool true for success, false for an unknown font (error in log)
+      bool BuildQuads(const GlyphRun& run, FontHandle font, std::vector<GlyphQuad>& quads);
 
-      int32_t CharWidth(const char* pFontName, uint32_t codepoint);
+      //! @brief Layout() and BuildQuads() in one step
+      //! @param[out] w Width of the text (in pixels)
+      //! @param[out] h Height of the text (in pixels)
+      bool BuildQuads(const char* pString, FontHandle font, std::vector<GlyphQuad>& quads,
+                      uint32_t& w, uint32_t& h);
+
+      //! @brief Texture of an atlas page of a font
+      //! @return OpenGL texture, 0 for an unknown font or page
+      uint32_t AtlasTexture(FontHandle font, uint32_t page);
+
+      //! @brief Advance of a codepoint (in pixels), 0 for an unknown font or codepoint
+      int32_t CharWidth(FontHandle font, uint32_t codepoint);
 
       ~FontLibrary();
      private:
-      std::map<std::string, Font*> mFonts;
+      FontHandle Add(const char* pFontName, const char* pFontFile, uint32_t pointSize, bool bSdf,
+                     const CodepointRange* pPreload, uint32_t preloadCount);
+      //! @brief Font of a handle, NULL (error in log) for an invalid handle
+      Font* Get(FontHandle font) const;
+
+      std::map<std::string, FontHandle> mNames;  //!< Setup time lookups only
+      std::vector<Font*> mFonts;                 //!< Font of handle h at h - 1
+      std::vector<MappedFile*> mCacheFiles;  //!< Mapped by LoadCache()
+      std::mutex mMutex;                     //!< Guards the fonts, their caches and atlases
    };
 
 
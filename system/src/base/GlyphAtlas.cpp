@@ -0,0 +1,165 @@
+#include "GlyphAtlas.h"
+
+#include "glad/glad.h"
+
+#include "Log.h"
+
+// Empty texels between bitmaps, so linear filtering does not pick up the neighbours
+constexpr uint32_t PADDING = 1;
+
+// One byte of coverage per texel, the FONT shader reads it from the red channel
+#ifdef GL_ES_VERSION_3_0
+constexpr GLint PAGE_INTERNAL_FORMAT = GL_R8;
+constexpr GLenum PAGE_FORMAT = GL_RED;
+#else
+// GLES2 has no red textures, luminance puts the coverage in red (and green and blue)
+constexpr GLint PAGE_INTERNAL_FORMAT = GL_LUMINANCE;
+constexpr GLenum PAGE_FORMAT = GL_LUMINANCE;
+#endif
+
+GlyphAtlas::GlyphAtlas(uint32_t pageSize) : mPageSize(pageSize)
+{
+}
+
+GlyphAtlas::~GlyphAtlas()
+{
+   for (Page& page : mPages)
+   {
+      if (page.texture)
+      {
+         glDeleteTextures(1, &page.texture);
+      }
+   }
+}
+
+uint32_t GlyphAtlas::Texture(uint32_t page)
+{
+   Flush();
+   return (page < mPages.size()) ? mPages[page].texture : 0;
+}
+
+bool GlyphAtlas::Add(const uint8_t* pCoverage, uint32_t w, uint32_t h, AtlasRegion& region)
+{
+   if (((w + PADDING) > mPageSize) || ((h + PADDING) > mPageSize))
+   {
+      addlog(Log::L_ERROR, "Glyph too large for the atlas (%ux%u)\n", w, h);
+      return false;
+   }
+
+   // try the last page first, earlier pages are (nearly) full
+   uint32_t x = 0;
+   uint32_t y = 0;
+   if (mPages.empty() || !Place(mPages.back(), w + PADDING, h + PADDING, x, y))
+   {
+      Page page;
+      page.texture = 0;
+      page.top = 0;
+      page.pPrebuilt = nullptr;
+      mPages.push_back(page);
+      Place(mPages.back(), w + PADDING, h + PADDING, x, y);
+   }
+   region.page = static_cast<uint32_t>(mPages.size() - 1);
+
+   // queue the upload
+   if ((w > 0) && (h > 0))
+   {
+      mPending.push_back({region.page, x, y, w, h, mPendingPixels.size()});
+      mPendingPixels.insert(mPendingPixels.end(), pCoverage, pCoverage + (w * h));
+   }
+
+   float scale = 1.0f / mPageSize;
+   region.u0 = x * scale;
+   region.v0 = y * scale;
+   region.u1 = (x + w) * scale;
+   region.v1 = (y + h) * scale;
+   return true;
+}
+
+uint32_t GlyphAtlas::AddPage(const uint8_t* pPixels)
+{
+   Page page;
+   page.texture = 0;
+   page.top = mPageSize;  // full
+   page.pPrebuilt = pPixels;
+   mPages.push_back(page);
+   return static_cast<uint32_t>(mPages.size() - 1);
+}
+
+bool GlyphAtlas::Place(Page& page, uint32_t w, uint32_t h, uint32_t& x, uint32_t& y)
+{
+   // the lowest shelf with room wastes the least height
+   Shelf* pBest = nullptr;
+   for (Shelf& shelf : page.shelves)
+   {
+      if ((h <= shelf.height) && ((shelf.x + w) <= mPageSize) &&
+          (!pBest || (shelf.height < pBest->height)))
+      {
+         pBest = &shelf;
+      }
+   }
+
+   // a shelf much taller than the bitmap would waste its height, open a new one instead
+   if ((!pBest || (pBest->height > (h + (h / 2)))) && ((page.top + h) <= mPageSize))
+   {
+      page.shelves.push_back({page.top, h, 0});
+      page.top += h;
+      pBest = &page.shelves.back();
+   }
+   if (!pBest)
+   {
+      return false;
+   }
+
+   x = pBest->x;
+   y = pBest->y;
+   pBest->x += w;
+   return true;
+}
+
+void GlyphAtlas::CreateTexture(Page& page)
+{
+   // cleared page, the padding must stay transparent
+   std::vector<uint8_t> clear;
+   if (!page.pPrebuilt)
+   {
+      clear.resize(mPageSize * mPageSize, 0);
+   }
+   glGenTextures(1, &page.texture);
+   glBindTexture(GL_TEXTURE_2D, page.texture);
+   glPixelStorei(GL_UNPACK_ALIGNMENT, 1);
+   glTexImage2D(GL_TEXTURE_2D, 0, PAGE_INTERNAL_FORMAT, mPageSize, mPageSize, 0, PAGE_FORMAT,
+                GL_UNSIGNED_BYTE, page.pPrebuilt ? page.pPrebuilt : clear.data());
+   page.pPrebuilt = nullptr;
+   glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MIN_FILTER, GL_LINEAR);
+   glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MAG_FILTER, GL_LINEAR);
+   glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_WRAP_S, GL_CLAMP_TO_EDGE);
+   glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_WRAP_T, GL_CLAMP_TO_EDGE);
+   glBindTexture(GL_TEXTURE_2D, 0);
+}
+
+void GlyphAtlas::Flush()
+{
+   for (Page& page : mPages)
+   {
+      if (!page.texture)
+      {
+         CreateTexture(page);
+      }
+   }
+   if (mPending.empty())
+   {
+      return;
+   }
+
+   // rows are tightly packed, any width
+   glPixelStorei(GL_UNPACK_ALIGNMENT, 1);
+   for (const Pending& p : mPending)
+   {
+      glBindTexture(GL_TEXTURE_2D, mPages[p.page].texture);
+      glTexSubImage2D(GL_TEXTURE_2D, 0, p.x, p.y, p.w, p.h, PAGE_FORMAT, GL_UNSIGNED_BYTE,
+                      &mPendingPixels[p.offset]);
+   }
+   glBindTexture(GL_TEXTURE_2D, 0);
+   mPending.clear();
+   mPendingPixels.clear();
+}
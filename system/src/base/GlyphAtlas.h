@@ -0,0 +1,89 @@
+#ifndef __GLYPH_ATLAS_H__
+#define __GLYPH_ATLAS_H__
+#include <stddef.h>
+#include <stdint.h>
+#include <vector>
+
+   //! @brief Location of a glyph bitmap in a GlyphAtlas.
+   struct AtlasRegion
+   {
+      uint32_t page;         //!< Atlas page (texture) holding the bitmap
+      float u0, v0, u1, v1;  //!< Texture coordinates of the bitmap (upper left, lower right)
+   };
+
+   //! @brief Glyph bitmaps of one font packed into shared texture pages.
+   //! @par Bitmaps are placed on shelves (rows as tall as their tallest bitmap) filled left
+   //! to right, a new shelf opens below the last one and a new page when a page is full.
+   //! Each bitmap is uploaded once with glTexSubImage2D, the text renderers draw one quad
+   //! per glyph from the pages. Pages are single channel (GL_R8, GL_LUMINANCE on GLES2),
+   //! one byte per texel.
+   //! @par Add() only packs and queues the bitmap, the uploads are done by Texture(), so
+   //! glyphs can be added before there is a GL context (font preloading).
+   class GlyphAtlas
+   {
+     public:
+      //! @brief Constructor
+      //! @param[in] pageSize Width and height of the page textures (in pixels)
+      GlyphAtlas(uint32_t pageSize = 512);
+      ~GlyphAtlas();
+
+      //! @brief Pack and upload a glyph bitmap
+      //! @param[in] pCoverage 8 bit coverage, w * h bytes, rows top to bottom
+      //! @param[in] w Bitmap width (in pixels)
+      //! @param[in] h Bitmap height (in pixels)
+      //! @param[out] region Where the bitmap went
+      //! @return bool true for success, false if the bitmap is larger than a page
+      bool Add(const uint8_t* pCoverage, uint32_t w, uint32_t h, AtlasRegion& region);
+
+      //! @brief Add a page packed ahead of time (font cache), no glyph is added to it later
+      //! @param[in] pPixels pageSize * pageSize bytes, read by the upload: they must stay
+      //! valid until the next Texture() call
+      //! @return uint32_t Page index
+      uint32_t AddPage(const uint8_t* pPixels);
+
+      //! @brief Texture of a page (0 if the page does not exist), uploads the queued bitmaps
+      //! @par Needs a current GL context.
+      uint32_t Texture(uint32_t page);
+      uint32_t PageCount() const { return static_cast<uint32_t>(mPages.size()); }
+
+      GlyphAtlas(const GlyphAtlas&) = delete;
+      GlyphAtlas& operator=(const GlyphAtlas&) = delete;
+
+     private:
+      struct Shelf
+      {
+         uint32_t y;       //!< Top of the shelf
+         uint32_t height;  //!< Height of the shelf
+         uint32_t x;       //!< First free column
+      };
+
+      struct Page
+      {
+         uint32_t texture;  //!< 0 until the first Texture() call
+         std::vector<Shelf> shelves;
+         uint32_t top;              //!< First row below the last shelf
+         const uint8_t* pPrebuilt;  //!< Pixels of an AddPage() page until its upload
+      };
+
+      //! @brief Bitmap waiting for its upload
+      struct Pending
+      {
+         uint32_t page;
+         uint32_t x, y, w, h;
+         size_t offset;  //!< Coverage in mPendingPixels
+      };
+
+      //! @brief Find room for a w x h rectangle in a page
+      //! @return bool true with the position in x, y, false if the page is full
+      bool Place(Page& page, uint32_t w, uint32_t h, uint32_t& x, uint32_t& y);
+      void CreateTexture(Page& page);
+      //! @brief Create the missing textures and upload the queued bitmaps
+      void Flush();
+
+      uint32_t mPageSize;
+      std::vector<Page> mPages;
+      std::vector<Pending> mPending;
+      std::vector<uint8_t> mPendingPixels;
+   };
+
+#endif  // __GLYPH_ATLAS_H__
@@ -0,0 +1,82 @@
+#include "GlyphCache.h"
+
+// Slots allocated for the first codepoint outside of the direct range (log2)
+constexpr uint32_t INITIAL_BITS = 6;
+
+GlyphCache::GlyphCache() : miBits(0), miCount(0)
+{
+   for (uint32_t i = 0; i < DIRECT_SIZE; i++)
+   {
+      mDirect[i] = NOT_LOADED;
+   }
+}
+
+uint32_t GlyphCache::Hash(uint32_t codepoint) const
+{
+   // Fibonacci hashing, the top bits are well mixed even for consecutive codepoints
+   return (codepoint * 2654435769u) >> (32 - miBits);
+}
+
+int32_t GlyphCache::FindHashed(uint32_t codepoint) const
+{
+   if (mSlots.empty())
+   {
+      return NOT_LOADED;
+   }
+   uint32_t mask = static_cast<uint32_t>(mSlots.size()) - 1;
+   for (uint32_t i = Hash(codepoint);; i = (i + 1) & mask)
+   {
+      const Slot& slot = mSlots[i];
+      if (slot.codepoint == codepoint)
+      {
+         return slot.index;
+      }
+      if (slot.codepoint == EMPTY)
+      {
+         return NOT_LOADED;
+      }
+   }
+}
+
+void GlyphCache::Insert(uint32_t codepoint, int32_t index)
+{
+   if (codepoint < DIRECT_SIZE)
+   {
+      mDirect[codepoint] = index;
+      return;
+   }
+
+   // keep the load under 3/4, the probe sequences stay short
+   if (((miCount + 1) * 4) > (mSlots.size() * 3))
+   {
+      Grow();
+   }
+   uint32_t mask = static_cast<uint32_t>(mSlots.size()) - 1;
+   uint32_t i = Hash(codepoint);
+   while ((mSlots[i].codepoint != EMPTY) && (mSlots[i].codepoint != codepoint))
+   {
+      i = (i + 1) & mask;
+   }
+   if (mSlots[i].codepoint == EMPTY)
+   {
+      miCount++;
+   }
+   mSlots[i].codepoint = codepoint;
+   mSlots[i].index = index;
+}
+
+void GlyphCache::Grow()
+{
+   std::vector<Slot> old;
+   old.swap(mSlots);
+   miBits = old.empty() ? INITIAL_BITS : miBits + 1;
+   mSlots.assign(1u << miBits, Slot{EMPTY, NOT_LOADED});
+   miCount = 0;
+   for (const Slot& slot : old)
+   {
+      if (slot.codepoint != EMPTY)
+      {
+         Insert(slot.codepoint, slot.index);
+      }
+   }
+}
@@ -0,0 +1,55 @@
+#ifndef __GLYPH_CACHE_H__
+#define __GLYPH_CACHE_H__
+#include <stdint.h>
+#include <vector>
+
+   //! @brief Codepoint to glyph index map of a font.
+   //! @par ASCII and Latin-1 (the bulk of the text) are looked up directly in a table, the
+   //! rest in an open addressing hash table (linear probing), so finding a glyph costs no
+   //! allocation and at most a few probes in flat memory. Codepoints the font does not have
+   //! are cached too (MISSING), they are not looked up in the font again.
+   class GlyphCache
+   {
+     public:
+      static const int32_t NOT_LOADED = -1;  //!< Find(): not cached yet
+      static const int32_t MISSING = -2;     //!< Find(): the font has no glyph for it
+
+      GlyphCache();
+
+      //! @brief Look up a codepoint
+      //! @return Glyph index, NOT_LOADED or MISSING
+      int32_t Find(uint32_t codepoint) const
+      {
+         if (codepoint < DIRECT_SIZE)
+         {
+            return mDirect[codepoint];
+         }
+         return FindHashed(codepoint);
+      }
+
+      //! @brief Cache a codepoint
+      //! @param[in] codepoint Codepoint
+      //! @param[in] index Glyph index, or MISSING
+      void Insert(uint32_t codepoint, int32_t index);
+
+     private:
+      static const uint32_t DIRECT_SIZE = 256;  //!< ASCII + Latin-1
+      static const uint32_t EMPTY = 0xFFFFFFFF;  //!< Not a codepoint, marks free slots
+
+      struct Slot
+      {
+         uint32_t codepoint;
+         int32_t index;
+      };
+
+      int32_t FindHashed(uint32_t codepoint) const;
+      uint32_t Hash(uint32_t codepoint) const;
+      void Grow();
+
+      int32_t mDirect[DIRECT_SIZE];
+      std::vector<Slot> mSlots;  //!< Power of two size
+      uint32_t miBits;           //!< log2 of the slot count
+      uint32_t miCount;          //!< Used slots
+   };
+
+#endif  // __GLYPH_CACHE_H__
@@ -0,0 +1,122 @@
+#include "MappedFile.h"
+
+#ifdef PLATFORM_WINDOWS
+#include <windows.h>
+#else
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+#endif
+
+#include "Log.h"
+
+MappedFile::MappedFile()
+   : mpData(nullptr), mSize(0)
+#ifdef PLATFORM_WINDOWS
+   , mhFile(INVALID_HANDLE_VALUE), mhMapping(nullptr)
+#endif
+{
+}
+
+MappedFile::~MappedFile()
+{
+   Close();
+}
+
+#ifdef PLATFORM_WINDOWS
+
+bool MappedFile::Open(const char* pFileName)
+{
+   Close();
+   mhFile = CreateFileA(pFileName, GENERIC_READ, FILE_SHARE_READ, nullptr, OPEN_EXISTING,
+                        FILE_ATTRIBUTE_NORMAL, nullptr);
+   if (mhFile == INVALID_HANDLE_VALUE)
+   {
+      addlog(Log::L_ERROR, "Can't open %s", pFileName);
+      return false;
+   }
+   LARGE_INTEGER size;
+   if (!GetFileSizeEx(mhFile, &size) || (size.QuadPart == 0))
+   {
+      addlog(Log::L_ERROR, "Empty file %s", pFileName);
+      Close();
+      return false;
+   }
+   mhMapping = CreateFileMappingA(mhFile, nullptr, PAGE_READONLY, 0, 0, nullptr);
+   if (mhMapping)
+   {
+      mpData = static_cast<const uint8_t*>(MapViewOfFile(mhMapping, FILE_MAP_READ, 0, 0, 0));
+   }
+   if (!mpData)
+   {
+      addlog(Log::L_ERROR, "Can't map %s", pFileName);
+      Close();
+      return false;
+   }
+   mSize = static_cast<size_t>(size.QuadPart);
+   return true;
+}
+
+void MappedFile::Close()
+{
+   if (mpData)
+   {
+      UnmapViewOfFile(mpData);
+   }
+   if (mhMapping)
+   {
+      CloseHandle(mhMapping);
+   }
+   if (mhFile != INVALID_HANDLE_VALUE)
+   {
+      CloseHandle(mhFile);
+   }
+   mpData = nullptr;
+   mSize = 0;
+   mhMapping = nullptr;
+   mhFile = INVALID_HANDLE_VALUE;
+}
+
+#else
+
+bool MappedFile::Open(const char* pFileName)
+{
+   Close();
+   int fd = open(pFileName, O_RDONLY);
+   if (fd < 0)
+   {
+      addlog(Log::L_ERROR, "Can't open %s", pFileName);
+      return false;
+   }
+   struct stat st;
+   if ((fstat(fd, &st) != 0) || (st.st_size == 0))
+   {
+      addlog(Log::L_ERROR, "Empty file %s", pFileName);
+      close(fd);
+      return false;
+   }
+   void* p = mmap(nullptr, st.st_size, PROT_READ, MAP_PRIVATE, fd, 0);
+   // the mapping keeps its own reference to the file
+   close(fd);
+   if (p == MAP_FAILED)
+   {
+      addlog(Log::L_ERROR, "Can't map %s", pFileName);
+      return false;
+   }
+   mpData = static_cast<const uint8_t*>(p);
+   mSize = static_cast<size_t>(st.st_size);
+   return true;
+}
+
+void MappedFile::Close()
+{
+   if (mpData)
+   {
+      munmap(const_cast<uint8_t*>(mpData), mSize);
+   }
+   mpData = nullptr;
+   mSize = 0;
+}
+
+#endif
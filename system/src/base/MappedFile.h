@@ -0,0 +1,38 @@
+#ifndef __MAPPED_FILE_H__
+#define __MAPPED_FILE_H__
+#include <stddef.h>
+#include <stdint.h>
+
+   //! @brief Read only memory mapping of a whole file.
+   //! @par The file stays mapped until the object is destroyed (or Close() is called), pages
+   //! are loaded by the OS on first access.
+   class MappedFile
+   {
+     public:
+      MappedFile();
+      ~MappedFile();
+
+      //! @brief Map a file
+      //! @param[in] pFileName File to map
+      //! @return bool true for success, false for fail (error in log)
+      bool Open(const char* pFileName);
+
+      //! @brief Unmap the file (done by the destructor)
+      void Close();
+
+      const uint8_t* Data() const { return mpData; }
+      size_t Size() const { return mSize; }
+
+      MappedFile(const MappedFile&) = delete;
+      MappedFile& operator=(const MappedFile&) = delete;
+
+     private:
+      const uint8_t* mpData;
+      size_t mSize;
+#ifdef PLATFORM_WINDOWS
+      void* mhFile;
+      void* mhMapping;
+#endif
+   };
+
+#endif  // __MAPPED_FILE_H__
@@ -9,6 +9,9 @@
 
 #include "RenderPacket.h"
 #include "ESShaderRepository.h"
+#include "IPlatform.h"
+
+#include <algorithm>
 
 
 bool RenderPacket::compare_Z_decending (const RenderPacket* first, const RenderPacket* second)
@@ -31,8 +34,34 @@ bool RenderPacket::compare_Program (const RenderPacket* first, const RenderPacke
    return first->miShaderProgram < second->miShaderProgram;
 }
 
-RenderPacket::RenderPacket() : mfUniformArray(0)
+const Matrix4& RenderPacket::PixelProjection()
+{
+   static Matrix4 projection;
+   static uint32_t width = 0;
+   static uint32_t height = 0;
+
+   // rebuilt only if the screen size changed
+   IPlatform& rPlatform = IPlatform::instance();
+   if ((rPlatform.ScreenPixelWidth() != width) || (rPlatform.ScreenPixelHeight() != height))
+   {
+      width = rPlatform.ScreenPixelWidth();
+      height = rPlatform.ScreenPixelHeight();
+      projection.identity();
+      projection[0] = 2.0f / width;
+      projection[5] = -2.0f / height;
+      projection[12] = -1.0f;
+      projection[13] = 1.0f;
+   }
+   return projection;
+}
+
+RenderPacket::RenderPacket()
+   : mfUniformArray(0), mfOpacity(1.0f), mbPixelSpace(false), mfParamArray(0), miParamCount(0)
 {
+   // packets are created on the render thread
+   static unsigned int serial = 0;
+   miSerial = ++serial;
+
    mMasterZ = 0.05f;
    mbIsOpaque = true;
 
@@ -54,28 +83,68 @@ RenderPacket::RenderPacket() : mfUniformArray(0)
 
    miVertexCount        = 0;
    mfVertices           = 0;
+
+   mbDirty              = true;
+   miDirtyFirst         = 0;
+   miDirtyEnd           = 0xFFFFFFFF;
+   miBufferSize         = 0;
+   miUsage              = GL_STATIC_DRAW;
+
+   miIbo                = 0;
+   miIndexType          = GL_UNSIGNED_SHORT;
+   miIndexCount         = 0;
+   miIndexBufferCount   = 0;
+   mpIndices            = 0;
+   mbIndicesDirty       = true;
 }
 
 RenderPacket::~RenderPacket()
 {
 }
 
-void RenderPacket::Render()
+void RenderPacket::MarkDirty(unsigned int firstVertex, unsigned int count)
 {
-   // Bind the Texture and the VBO
-   if (miTextureArraySize > 0)
+   unsigned int end = (count > (0xFFFFFFFF - firstVertex)) ? 0xFFFFFFFF : firstVertex + count;
+   if (mbDirty)
    {
-      glBindTexture(GL_TEXTURE_2D, miTexture);
+      // grow the pending range
+      miDirtyFirst = std::min(miDirtyFirst, firstVertex);
+      miDirtyEnd = std::max(miDirtyEnd, end);
    }
    else
    {
-      glBindTexture(GL_TEXTURE_2D, 0);
+      miDirtyFirst = firstVertex;
+      miDirtyEnd = end;
    }
+   mbDirty = true;
+}
+
+void RenderPacket::Render()
+{
+   // Bind the Texture (0 for none, a shader may sample it without texture coordinates)
+   // and the VBO
+   glBindTexture(GL_TEXTURE_2D, miTexture);
 
    glBindBuffer(GL_ARRAY_BUFFER, miVbo);
 
-   // Set the buffer's data
-   glBufferData(GL_ARRAY_BUFFER, miVertexCount * miVertexStride, mfVertices, GL_STATIC_DRAW);
+   // Upload the vertices only when they changed, and only the changed range if possible
+   unsigned int iSize = miVertexCount * miVertexStride;
+   if (iSize != miBufferSize)
+   {
+      glBufferData(GL_ARRAY_BUFFER, iSize, mfVertices, miUsage);
+      miBufferSize = iSize;
+   }
+   else if (mbDirty)
+   {
+      unsigned int iEnd = std::min(miDirtyEnd, miVertexCount);
+      if (miDirtyFirst < iEnd)
+      {
+         glBufferSubData(GL_ARRAY_BUFFER, miDirtyFirst * miVertexStride,
+                         (iEnd - miDirtyFirst) * miVertexStride,
+                         reinterpret_cast<const char*>(mfVertices) + (miDirtyFirst * miVertexStride));
+      }
+   }
+   mbDirty = false;
 
    // Pass the vertex data
    glEnableVertexAttribArray(VERTEX_ARRAY);
@@ -102,17 +171,45 @@ void RenderPacket::Render()
    int i32Location = glGetUniformLocation(miShaderProgram, "uModelview");
    glUniformMatrix4fv(i32Location, 1, GL_FALSE, mTransform.get());
 
-   if (mfUniformArray)
+   // one projection for every packet of the same space
+   static const Matrix4 identity;
+   int iProjectionLocation = glGetUniformLocation(miShaderProgram, "uProjection");
+   glUniformMatrix4fv(iProjectionLocation, 1, GL_FALSE,
+                      mbPixelSpace ? PixelProjection().get() : identity.get());
+
+   // set color (uColor), white if the packet has none, with the opacity applied
+   static const float white[4] = {1.0f, 1.0f, 1.0f, 1.0f};
+   const float* pColor = mfUniformArray ? mfUniformArray : white;
+   int iColorLocation = glGetUniformLocation(miShaderProgram, "uColor");
+   glUniform4f(iColorLocation, pColor[0], pColor[1], pColor[2], pColor[3] * mfOpacity);
+
+   if (mfParamArray && (miParamCount > 0))
    {
-      // set color (uColor)
-      int iColorLocation = glGetUniformLocation(miShaderProgram, "uColor");
-      glUniform4fv(iColorLocation, 1, mfUniformArray);
+      // set shader specific parameters (uParams)
+      int iParamLocation = glGetUniformLocation(miShaderProgram, "uParams");
+      glUniform4fv(iParamLocation, miParamCount, mfParamArray);
    }
 
    glBlendFunc(GL_SRC_ALPHA, GL_ONE_MINUS_SRC_ALPHA);
    glEnable(GL_BLEND);
 
-   glDrawArrays(miType, 0, miVertexCount);
+   if (miIndexCount > 0)
+   {
+      unsigned int iIndexSize = (miIndexType == GL_UNSIGNED_INT) ? 4 : 2;
+      glBindBuffer(GL_ELEMENT_ARRAY_BUFFER, miIbo);
+      if (mbIndicesDirty)
+      {
+         unsigned int iCount = (miIndexBufferCount > 0) ? miIndexBufferCount : miIndexCount;
+         glBufferData(GL_ELEMENT_ARRAY_BUFFER, iCount * iIndexSize, mpIndices, GL_STATIC_DRAW);
+         mbIndicesDirty = false;
+      }
+      glDrawElements(miType, miIndexCount, miIndexType, 0);
+      glBindBuffer(GL_ELEMENT_ARRAY_BUFFER, 0);
+   }
+   else
+   {
+      glDrawArrays(miType, 0, miVertexCount);
+   }
    glDisable(GL_BLEND);
 
    // Unbind the VBO and texture
@@ -18,11 +18,20 @@ public:
 
    void Render();
 
+   //! @brief Flag vertices as changed so the next Render() uploads them.
+   //! @param[in] firstVertex First changed vertex.
+   //! @param[in] count Number of changed vertices (default through the last one).
+   void MarkDirty(unsigned int firstVertex = 0, unsigned int count = 0xFFFFFFFF);
+
    static bool compare_Z_decending (const RenderPacket* first, const RenderPacket* second);
    static bool compare_Z_ascending (const RenderPacket* first, const RenderPacket* second);
    static bool compare_Texture (const RenderPacket* first, const RenderPacket* second);
    static bool compare_Program (const RenderPacket* first, const RenderPacket* second);
 
+   //! @brief Projection of the pixel space packets: x right, y down, origin at the top left
+   //! of the screen, one unit per pixel.
+   static const Matrix4& PixelProjection();
+
    float mMasterZ;
    bool mbIsOpaque;
 
@@ -44,7 +53,26 @@ public:
    unsigned int miVertexStride;
    unsigned int miVertexCount;
    float* mfVertices;
+
+   bool mbDirty;                 // Vertices changed since the last upload
+   unsigned int miDirtyFirst;    // First changed vertex
+   unsigned int miDirtyEnd;      // One past the last changed vertex
+   unsigned int miBufferSize;    // Bytes allocated for miVbo (0 before the first upload)
+   unsigned int miUsage;         // GL_STATIC_DRAW, GL_DYNAMIC_DRAW or GL_STREAM_DRAW
+
+   unsigned int miIbo;           // Index buffer, only used when miIndexCount > 0
+   unsigned int miIndexType;     // GL_UNSIGNED_SHORT or GL_UNSIGNED_INT
+   unsigned int miIndexCount;    // 0 draws the vertices in order
+   unsigned int miIndexBufferCount;  // Indices uploaded from mpIndices (0 for miIndexCount),
+                                     // so the drawn count can change without an upload
+   const void* mpIndices;
+   bool mbIndicesDirty;          // Indices changed since the last upload
    const float* mfUniformArray;
+   float mfOpacity;              // Multiplied with the uColor alpha (animated opacity)
+   bool mbPixelSpace;            // Vertices in pixels (PixelProjection), clip space otherwise
+   unsigned int miSerial;        // Unique per packet, a new packet can reuse a deleted address
+   const float* mfParamArray;    // vec4 array passed to uParams (shader specific)
+   unsigned int miParamCount;    // Number of vec4 in mfParamArray
 };
 
 
@@ -0,0 +1,84 @@
+#include "TextCache.h"
+
+// Default memory for unreferenced layouts
+constexpr size_t DEFAULT_BUDGET = 256 * 1024;
+
+TextCache::TextCache() : mBudget(DEFAULT_BUDGET), mBytes(0), mUnusedBytes(0)
+{
+}
+
+TextCache& TextCache::instance()
+{
+   // Classic Singleton Pattern
+   static TextCache cache;
+   return cache;
+}
+
+const TextCache::Entry* TextCache::Acquire(FontHandle font, const char* pString)
+{
+   std::string key(reinterpret_cast<const char*>(&font), sizeof(font));
+   key += pString;
+
+   std::unordered_map<std::string, Entry>::iterator it = mEntries.find(key);
+   if (it != mEntries.end())
+   {
+      Entry& entry = (*it).second;
+      if (entry.refs++ == 0)
+      {
+         mUnused.erase(entry.lru);
+         mUnusedBytes -= entry.bytes;
+      }
+      return &entry;
+   }
+
+   Entry entry;
+   FontLibrary& rFonts = FontLibrary::instance();
+   if (!rFonts.Layout(pString, font, entry.run) || !rFonts.BuildQuads(entry.run, font, entry.quads))
+   {
+      return NULL;
+   }
+   entry.refs = 1;
+   entry.bytes = sizeof(Entry) + key.size() + (entry.run.glyphs.size() * sizeof(GlyphPosition)) +
+                 (entry.quads.size() * sizeof(GlyphQuad));
+   mBytes += entry.bytes;
+
+   it = mEntries.emplace(key, std::move(entry)).first;
+   (*it).second.pKey = &(*it).first;
+   return &(*it).second;
+}
+
+void TextCache::Release(const Entry* pEntry)
+{
+   if (!pEntry)
+   {
+      return;
+   }
+   // handed out const so the users can't change it, the cache owns it
+   Entry* pMutable = const_cast<Entry*>(pEntry);
+   if (--pMutable->refs == 0)
+   {
+      mUnused.push_front(pMutable);
+      pMutable->lru = mUnused.begin();
+      mUnusedBytes += pMutable->bytes;
+      Trim();
+   }
+}
+
+void TextCache::SetBudget(size_t bytes)
+{
+   mBudget = bytes;
+   Trim();
+}
+
+void TextCache::Trim()
+{
+   // the referenced layouts stay whatever their size, they don't count
+   while (mUnusedBytes > mBudget)
+   {
+      Entry* pOldest = mUnused.back();
+      mUnused.pop_back();
+      mUnusedBytes -= pOldest->bytes;
+      mBytes -= pOldest->bytes;
+      mEntries.erase(mEntries.find(*pOldest->pKey));
+   }
+}
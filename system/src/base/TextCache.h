@@ -0,0 +1,74 @@
+#ifndef __TEXT_CACHE_H__
+#define __TEXT_CACHE_H__
+#include <stddef.h>
+#include <stdint.h>
+#include <list>
+#include <string>
+#include <unordered_map>
+#include <vector>
+
+#include "FontLibrary.h"
+
+   //! @brief Shared, reference counted layouts of the strings on screen.
+   //! @par Texts showing the same string in the same font ("OK", units, digits...) share
+   //! one layout, built once by FontLibrary::Layout() and BuildQuads(). The color is a
+   //! uniform of the text packets, it is not part of the key. Layouts nobody references are
+   //! kept for reuse and evicted least recently used first once the cache is over its byte
+   //! budget.
+   //! @par Classic Singleton pattern
+   class TextCache
+   {
+     public:
+      //! @brief A cached layout, read only for the users
+      struct Entry
+      {
+         GlyphRun run;                  //!< Glyphs and kerned positions
+         std::vector<GlyphQuad> quads;  //!< One quad per glyph with pixels
+
+        private:
+         friend class TextCache;
+         const std::string* pKey;
+         uint32_t refs;
+         size_t bytes;
+         std::list<Entry*>::iterator lru;  //!< Position in mUnused when refs is 0
+      };
+
+      //! @brief Return the instance of the singleton
+      //! @return reference to the singleton instance
+      static TextCache& instance();
+
+      //! @brief Get the layout of a string, built if it is not cached
+      //! @param[in] font Registered font
+      //! @param[in] pString UTF-8 string
+      //! @return Referenced entry, release it with Release(). NULL for an unknown font.
+      const Entry* Acquire(FontHandle font, const char* pString);
+
+      //! @brief Drop a reference from Acquire()
+      void Release(const Entry* pEntry);
+
+      //! @brief Bytes the unreferenced layouts may use (default 256 KB), referenced layouts
+      //! are never evicted
+      void SetBudget(size_t bytes);
+
+      //! @brief Bytes used by all the cached layouts
+      size_t Bytes() const { return mBytes; }
+
+      //! @brief Bytes used by the unreferenced layouts, the part held to the budget
+      size_t UnusedBytes() const { return mUnusedBytes; }
+
+      TextCache(const TextCache&) = delete;
+      TextCache& operator=(const TextCache&) = delete;
+
+     private:
+      TextCache();
+      //! @brief Evict unreferenced layouts until the cache fits its budget
+      void Trim();
+
+      std::unordered_map<std::string, Entry> mEntries;  //!< Key: font handle bytes, string
+      std::list<Entry*> mUnused;                        //!< Unreferenced, most recent first
+      size_t mBudget;
+      size_t mBytes;        //!< All the entries
+      size_t mUnusedBytes;  //!< Entries in mUnused
+   };
+
+#endif  // __TEXT_CACHE_H__
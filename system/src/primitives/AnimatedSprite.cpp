@@ -0,0 +1,173 @@
+#include "IPlatform.h"
+
+#include "glad/glad.h"
+#include <GLES2/gl2.h>
+#include <algorithm>
+
+#include "AnimatedSprite.h"
+#include "RenderPacket.h"
+
+AnimatedSprite::AnimatedSprite(const ScreenRect& r, const char* pImageSpec, int columns, int rows,
+                               int frameCount, float fps)
+    : BaseSprite(r, pImageSpec),
+      mColumns(columns),
+      mRows(rows),
+      mFrameCount((frameCount > 0) ? std::min(frameCount, columns * rows) : columns * rows),
+      mfFps(fps),
+      mStartTime(-1),
+      mbPlaying(true),
+      mbLoop(true),
+      mCurrent(0)
+{
+}
+
+AnimatedSprite::AnimatedSprite(const ScreenRect& r, const char* pImageSpec,
+                               const std::vector<ScreenRect>& frames, float fps)
+    : BaseSprite(r, pImageSpec),
+      mColumns(0),
+      mRows(0),
+      mFrameCount(0),
+      mFrames(frames),
+      mfFps(fps),
+      mStartTime(-1),
+      mbPlaying(true),
+      mbLoop(true),
+      mCurrent(0)
+{
+}
+
+AnimatedSprite::~AnimatedSprite()
+{
+}
+
+void AnimatedSprite::Instantiate()
+{
+    bool bAutoWidth = (mScreen.w <= 0);
+    bool bAutoHeight = (mScreen.h <= 0);
+    LoadTexture();
+    if ((w <= 0) || (h <= 0))
+    {
+        return;
+    }
+
+    // frame rectangles of a grid sheet
+    if ((mColumns > 0) && (mRows > 0) && mFrames.empty())
+    {
+        float fw = static_cast<float>(w) / mColumns;
+        float fh = static_cast<float>(h) / mRows;
+        for (int i = 0; i < mFrameCount; i++)
+        {
+            mFrames.push_back(ScreenRect((i % mColumns) * fw, (i / mColumns) * fh, fw, fh));
+        }
+    }
+    if (mFrames.empty())
+    {
+        mFrames.push_back(ScreenRect(0, 0, static_cast<float>(w), static_cast<float>(h)));
+    }
+
+    // half a texel inside the frame, the linear filter would blend in the next frame
+    mUVs.clear();
+    for (const ScreenRect& f : mFrames)
+    {
+        float ix = std::min(0.5f, f.w / 2);
+        float iy = std::min(0.5f, f.h / 2);
+        mUVs.push_back((f.x + ix) / w);
+        mUVs.push_back((f.y + iy) / h);
+        mUVs.push_back((f.x + f.w - ix) / w);
+        mUVs.push_back((f.y + f.h - iy) / h);
+    }
+
+    // the texture load sized the sprite for the whole sheet, use one frame
+    if (bAutoWidth)
+    {
+        mScreen.w = mFrames[0].w * TexelWidth();
+    }
+    if (bAutoHeight)
+    {
+        mScreen.h = mFrames[0].h * TexelHeight();
+    }
+
+    if (!mpRenderPacket)
+    {
+        CreatePacket(GL_TRIANGLE_STRIP, 4);
+    }
+    LoadVertexData();
+}
+
+void AnimatedSprite::LoadVertexData()
+{
+    BaseSprite::LoadVertexData();
+    ApplyFrame(mCurrent);
+}
+
+void AnimatedSprite::ApplyFrame(int frame)
+{
+    if (!mpRenderPacket || mUVs.empty())
+    {
+        return;
+    }
+    mCurrent = frame;
+
+    // UL, UR, LL, LR, only the texture coordinates change
+    const float* uv = &mUVs[frame * 4];
+    const float us[4] = {uv[0], uv[2], uv[0], uv[2]};
+    const float vs[4] = {uv[1], uv[1], uv[3], uv[3]};
+    unsigned int stride = mpRenderPacket->miVertexStride / sizeof(float);
+    float* pUV = mpRenderPacket->mfVertices + mpRenderPacket->miTextureArrayOffset;
+    for (int i = 0; i < 4; i++)
+    {
+        pUV[0] = us[i];
+        pUV[1] = vs[i];
+        pUV += stride;
+    }
+    mpRenderPacket->MarkDirty(0, 4);
+}
+
+void AnimatedSprite::Play()
+{
+    mbPlaying = true;
+    mStartTime = -1;
+    ApplyFrame(0);
+}
+
+void AnimatedSprite::Stop()
+{
+    mbPlaying = false;
+}
+
+void AnimatedSprite::SetFrame(int frame)
+{
+    mbPlaying = false;
+    if ((frame >= 0) && (frame < FrameCount()) && (frame != mCurrent))
+    {
+        ApplyFrame(frame);
+    }
+}
+
+void AnimatedSprite::Draw()
+{
+    int count = FrameCount();
+    if (mbPlaying && (count > 1) && (mfFps > 0))
+    {
+        double now = IPlatform::instance().CurrentTime();
+        if (mStartTime < 0)
+        {
+            mStartTime = now;
+        }
+        int frame = static_cast<int>((now - mStartTime) * mfFps);
+        if (mbLoop)
+        {
+            frame %= count;
+        }
+        else if (frame >= count)
+        {
+            frame = count - 1;
+            mbPlaying = false;
+        }
+        if (frame != mCurrent)
+        {
+            ApplyFrame(frame);
+        }
+    }
+    BaseSprite::Draw();
+}
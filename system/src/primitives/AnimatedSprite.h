@@ -0,0 +1,62 @@
+#ifndef ANIMATED_SPRITE_H
+#define ANIMATED_SPRITE_H
+#include <vector>
+
+#include "BaseSprite.h"
+
+//! @brief Sprite playing the frames of a sprite sheet.
+//! @par The whole sheet is one texture, a frame change only rewrites the texture
+//! coordinates of the 4 vertices. Frames advance with IPlatform::CurrentTime() when drawn.
+class AnimatedSprite : public BaseSprite
+{
+   public:
+    //! @brief Sheet of equal frames in a grid, played left to right, top to bottom.
+    //! @param[in] r Screen location, 0 width/height use the frame size.
+    //! @param[in] pImageSpec Sprite sheet image file.
+    //! @param[in] columns,rows Grid size.
+    //! @param[in] frameCount Number of frames (0 for columns * rows, at most columns * rows).
+    //! @param[in] fps Frames per second.
+    AnimatedSprite(const ScreenRect& r, const char* pImageSpec, int columns, int rows,
+                   int frameCount, float fps);
+    //! @brief Atlas with a list of frames.
+    //! @param[in] r Screen location, 0 width/height use the size of the first frame.
+    //! @param[in] pImageSpec Atlas image file.
+    //! @param[in] frames Frame rectangles in texture pixels (x, y from the top left, w, h).
+    //! @param[in] fps Frames per second.
+    AnimatedSprite(const ScreenRect& r, const char* pImageSpec,
+                   const std::vector<ScreenRect>& frames, float fps);
+    virtual ~AnimatedSprite();
+
+    virtual void Instantiate() override;
+    //! @brief Advance to the frame for the current time, then draw.
+    virtual void Draw() override;
+
+    //! @brief Start (or restart) playing from the first frame.
+    void Play();
+    //! @brief Stop on the current frame.
+    void Stop();
+    //! @brief Show a frame (stops playing).
+    void SetFrame(int frame);
+    //! @brief Loop back to the first frame at the end (default), or hold the last one.
+    void SetLoop(bool bLoop) { mbLoop = bLoop; }
+    void SetFps(float fps) { mfFps = fps; }
+
+    int FrameCount() const { return static_cast<int>(mFrames.size()); }
+
+   protected:
+    virtual void LoadVertexData() override;
+
+    //! @brief Write the texture coordinates of a frame into the vertices.
+    void ApplyFrame(int frame);
+
+    int mColumns, mRows, mFrameCount;  //!< Grid layout (0 columns for a frame list)
+    std::vector<ScreenRect> mFrames;   //!< Frame rectangles in texture pixels
+    std::vector<float> mUVs;           //!< u0, v0, u1, v1 of each frame
+    float mfFps;
+    double mStartTime;                 //!< Negative to start at the next Draw()
+    bool mbPlaying;
+    bool mbLoop;
+    int mCurrent;
+};
+
+#endif  // ANIMATED_SPRITE_H
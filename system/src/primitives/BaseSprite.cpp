@@ -14,8 +14,10 @@
 
 BaseSprite::BaseSprite()
     : IPrimitive(),
-      mpRenderPacket(0),
       msFilename(""),
+      w(0),
+      h(0),
+      n(0),
       mOGLHandle(TEXTURE_NOT_LOADED),
       mbTrim(false)
 {
@@ -24,8 +26,10 @@ BaseSprite::BaseSprite()
 
 BaseSprite::BaseSprite(const ScreenRect& r, const char* pImageSpec)
     : IPrimitive(),
-      mpRenderPacket(0),
       msFilename(pImageSpec),
+      w(0),
+      h(0),
+      n(0),
       mOGLHandle(TEXTURE_NOT_LOADED),
       mbTrim(false),
       mScreen(r)
@@ -38,6 +42,10 @@ BaseSprite::~BaseSprite()
     if (mpRenderPacket)
     {
         glDeleteBuffers(1, &mpRenderPacket->miVbo);
+        if (mpRenderPacket->miIbo)
+        {
+            glDeleteBuffers(1, &mpRenderPacket->miIbo);
+        }
         delete[] mpRenderPacket->mfVertices;
         delete mpRenderPacket;
     }
@@ -50,6 +58,7 @@ BaseSprite::~BaseSprite()
 void BaseSprite::SetScreenLocation(const ScreenRect& r)
 {
     mScreen = r;
+    LoadVertexData();
 }
 
 void BaseSprite::SetImage(const char* pImageSpec)
@@ -59,86 +68,124 @@ void BaseSprite::SetImage(const char* pImageSpec)
 
 void BaseSprite::Instantiate()
 {
-//    if (bActivate)
+    LoadTexture();
+    if (!mpRenderPacket)
+    {
+        CreatePacket(GL_TRIANGLE_STRIP, 4);
+    }
+    LoadVertexData();
+}
+
+void BaseSprite::LoadTexture()
+{
+    if (mOGLHandle != TEXTURE_NOT_LOADED)
     {
-        // Load up the image
-        unsigned char* pTexData = stbi_load(msFilename.c_str(), &w, &h, &n, 0);
-        if (pTexData)
+        return;
+    }
+
+    // Load up the image
+    unsigned char* pTexData = stbi_load(msFilename.c_str(), &w, &h, &n, 0);
+    if (pTexData)
+    {
+        // expand to image h/w if requested
+        if (mScreen.h <= 0)
         {
-            // expand to image h/w if requested
-            if (mScreen.h <= 0)
-            {
-                mScreen.h = static_cast<float>(h) / IPlatform::instance().ScreenPixelHeight();
-            }
-            if (mScreen.w <= 0)
-            {
-                mScreen.w = static_cast<float>(w) / IPlatform::instance().ScreenPixelWidth();
-            }
-
-            glGenTextures(1, &mOGLHandle);
-            // Binds this texture handle so we can load the data into it
-            glBindTexture(GL_TEXTURE_2D, mOGLHandle);
-
-            GLint format = GL_RGB;
-            if (n == 4)
-            {
-                format = GL_RGBA;
-            }
-
-            glTexImage2D(GL_TEXTURE_2D, 0, format, w, h, 0, format, GL_UNSIGNED_BYTE, pTexData);
-            glTexParameterf(GL_TEXTURE_2D, GL_TEXTURE_MIN_FILTER, GL_LINEAR);
-            glTexParameterf(GL_TEXTURE_2D, GL_TEXTURE_MAG_FILTER, GL_LINEAR);
-            glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_WRAP_S, GL_CLAMP_TO_EDGE);
-            glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_WRAP_T, GL_CLAMP_TO_EDGE);
-            glBindTexture(GL_TEXTURE_2D, 0);
-            free(pTexData);  // Yes, free. The library uses malloc and is a c language file, not cpp
+            mScreen.h = h * TexelHeight();
         }
-        if (!mpRenderPacket)
+        if (mScreen.w <= 0)
         {
-            mpRenderPacket = new RenderPacket;
-
-            // Init the render packet which will be passed to the scene graph on render.
-            mpRenderPacket->mMasterZ = 0.0f;
-
-            // Set the texture id
-            mpRenderPacket->miTexture = mOGLHandle;
-            // Create VBO for drawing the image
-            glGenBuffers(1, &mpRenderPacket->miVbo);
-            // Set the shader program
-            mpRenderPacket->miShaderProgram =
-                ESShaderRepository::Instance().GetShaderProgram(ESShaderRepository::COLOR_SPRITE);
-            // Set to no rotation etc...
-            mpRenderPacket->mTransform.identity();
-            // Set type of primatives
-            mpRenderPacket->miType = GL_TRIANGLE_STRIP;
-
-            // shader (COLOR_SPRITE)
-            mpRenderPacket->miVertArraySize = 3;
-            mpRenderPacket->miVertArrayOffset = 0;
-            mpRenderPacket->miTextureArraySize = 2;
-            mpRenderPacket->miTextureArrayOffset = 3;
-            mpRenderPacket->miColorArraySize = 4;
-            mpRenderPacket->miColorArrayOffset = 5;
-            mpRenderPacket->miVertexStride =
-                9 * sizeof(GLfloat);  // 3 floats for the pos, 2 for the UVs, 4 for color;
-
-            mpRenderPacket->miVertexCount = 4;
-            // copy verts to local buffer
-            mpRenderPacket->mfVertices =
-                new float[mpRenderPacket->miVertexStride * mpRenderPacket->miVertexCount];
+            mScreen.w = w * TexelWidth();
+        }
+
+        glGenTextures(1, &mOGLHandle);
+        // Binds this texture handle so we can load the data into it
+        glBindTexture(GL_TEXTURE_2D, mOGLHandle);
 
+        GLint format = GL_RGB;
+        if (n == 4)
+        {
+            format = GL_RGBA;
         }
+
+        glTexImage2D(GL_TEXTURE_2D, 0, format, w, h, 0, format, GL_UNSIGNED_BYTE, pTexData);
+        glTexParameterf(GL_TEXTURE_2D, GL_TEXTURE_MIN_FILTER, GL_LINEAR);
+        glTexParameterf(GL_TEXTURE_2D, GL_TEXTURE_MAG_FILTER, GL_LINEAR);
+        glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_WRAP_S, GL_CLAMP_TO_EDGE);
+        glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_WRAP_T, GL_CLAMP_TO_EDGE);
+        glBindTexture(GL_TEXTURE_2D, 0);
+        free(pTexData);  // Yes, free. The library uses malloc and is a c language file, not cpp
     }
 }
 
+void BaseSprite::CreatePacket(GLenum type, unsigned int vertexCount)
+{
+    mpRenderPacket = new RenderPacket;
+
+    // Init the render packet which will be passed to the scene graph on render.
+    mpRenderPacket->mMasterZ = 0.0f;
+
+    // Set the texture id
+    mpRenderPacket->miTexture = mOGLHandle;
+    // Create VBO for drawing the image
+    glGenBuffers(1, &mpRenderPacket->miVbo);
+    // Set the shader program
+    mpRenderPacket->miShaderProgram =
+        ESShaderRepository::Instance().GetShaderProgram(ESShaderRepository::COLOR_SPRITE);
+    // Set to no rotation etc...
+    mpRenderPacket->mTransform.identity();
+    mpRenderPacket->mbPixelSpace = mbPixelSpace;
+    // Set type of primatives
+    mpRenderPacket->miType = type;
+
+    // shader (COLOR_SPRITE)
+    mpRenderPacket->miVertArraySize = 3;
+    mpRenderPacket->miVertArrayOffset = 0;
+    mpRenderPacket->miTextureArraySize = 2;
+    mpRenderPacket->miTextureArrayOffset = 3;
+    mpRenderPacket->miColorArraySize = 4;
+    mpRenderPacket->miColorArrayOffset = 5;
+    mpRenderPacket->miVertexStride =
+        9 * sizeof(GLfloat);  // 3 floats for the pos, 2 for the UVs, 4 for color;
+
+    mpRenderPacket->miVertexCount = vertexCount;
+    // copy verts to local buffer
+    mpRenderPacket->mfVertices =
+        new float[mpRenderPacket->miVertexStride * mpRenderPacket->miVertexCount];
+}
+
+float BaseSprite::TexelWidth() const
+{
+    return mbPixelSpace ? 1.0f : 1.0f / IPlatform::instance().ScreenPixelWidth();
+}
+
+float BaseSprite::TexelHeight() const
+{
+    return mbPixelSpace ? 1.0f : 1.0f / IPlatform::instance().ScreenPixelHeight();
+}
+
+float BaseSprite::Down() const
+{
+    return mbPixelSpace ? 1.0f : -1.0f;
+}
+
+ScreenRect BaseSprite::SnappedScreen() const
+{
+    if (!mbPixelSpace)
+    {
+        return mScreen;
+    }
+    // snap the edges, not the size, so adjacent sprites stay adjacent
+    float left = floorf(mScreen.x + 0.5f);
+    float top = floorf(mScreen.y + 0.5f);
+    return ScreenRect(left, top, floorf(mScreen.x + mScreen.w + 0.5f) - left,
+                      floorf(mScreen.y + mScreen.h + 0.5f) - top);
+}
+
 void BaseSprite::Draw()
 {
     // Send the vertex buffer to be rendered
     if (mpRenderPacket)
     {
-        LoadVertexData();
-        mpRenderPacket->mTransform[12] = 0;
-        mpRenderPacket->mTransform[13] = 0;
         mpRenderPacket->Render();
     }
 }
@@ -149,6 +196,7 @@ void BaseSprite::SetVertexColors(const Color* c)
     {
         mColors[i] = c[i];
     }
+    LoadVertexData();
 }
 
 void BaseSprite::LoadVertexData()
@@ -157,10 +205,11 @@ void BaseSprite::LoadVertexData()
     {
         float dz = 0.0f;
 
-        float fTop = mScreen.y;
-        float fBottom = mScreen.y - mScreen.h;
-        float fLeft = mScreen.x;
-        float fRight = mScreen.x + mScreen.w;
+        ScreenRect r = SnappedScreen();
+        float fTop = r.y;
+        float fBottom = r.y + (Down() * r.h);
+        float fLeft = r.x;
+        float fRight = r.x + r.w;
 
         int vi = 0;
 
@@ -203,6 +252,8 @@ void BaseSprite::LoadVertexData()
         mpRenderPacket->mfVertices[vi++] = mColors[3].Green();  // G
         mpRenderPacket->mfVertices[vi++] = mColors[3].Blue();   // B
         mpRenderPacket->mfVertices[vi++] = mColors[3].Alpha();  // A
+
+        mpRenderPacket->MarkDirty();
     }
 }
 
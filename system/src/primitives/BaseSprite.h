@@ -29,9 +29,25 @@ class BaseSprite : public IPrimitive
     //    static BaseSprite* createSprite(Widget* pParent, const ScreenRect& r, const char*
     //    pImageSpec, bool bTrim);
 
-   private:
-    RenderPacket* mpRenderPacket;
-    void LoadVertexData();
+   protected:
+    //! @brief Load the image into a texture (once), sizes mScreen from it if needed.
+    void LoadTexture();
+    //! @brief Create the COLOR_SPRITE render packet.
+    //! @param[in] type GL primitive type.
+    //! @param[in] vertexCount Number of vertices to allocate.
+    void CreatePacket(GLenum type, unsigned int vertexCount);
+    //! @brief Write the vertices from mScreen and mColors.
+    virtual void LoadVertexData();
+
+    //! @brief Size of one texture pixel on screen: 1 in pixel space, a screen pixel in clip space.
+    float TexelWidth() const;
+    float TexelHeight() const;
+    //! @brief Direction from the top edge to the bottom edge: -1 in clip space (y up),
+    //! 1 in pixel space (y down).
+    float Down() const;
+    //! @brief mScreen, snapped to whole pixels in pixel space.
+    ScreenRect SnappedScreen() const;
+
     std::string msFilename;
     void SetVertexColors(const Color* c);
 
@@ -0,0 +1,240 @@
+#include "DynamicTextMesh.h"
+
+#include <algorithm>
+
+#include "glad/glad.h"
+
+#include "ESShaderRepository.h"
+#include "Log.h"
+#include "RenderPacket.h"
+
+// Floats per vertex: 3 for the pos, 2 for the UVs
+constexpr unsigned int FLOATS_PER_VERTEX = 5;
+constexpr unsigned int FLOATS_PER_SLOT = 4 * FLOATS_PER_VERTEX;
+// Quads addressable with 16 bit indices
+constexpr size_t MAX_QUADS = 65536 / 4;
+// Slots of a new mesh, a live value rarely needs more
+constexpr size_t MIN_CAPACITY = 16;
+
+static bool SameQuad(const GlyphQuad& a, const GlyphQuad& b)
+{
+   return (a.x0 == b.x0) && (a.y0 == b.y0) && (a.x1 == b.x1) && (a.y1 == b.y1) &&
+          (a.u0 == b.u0) && (a.v0 == b.v0) && (a.u1 == b.u1) && (a.v1 == b.v1) &&
+          (a.page == b.page);
+}
+
+DynamicTextMesh::DynamicTextMesh() : mCapacity(0), mbRewrite(false), mpColor(nullptr)
+{
+   mPlacement[0] = mPlacement[1] = 0;
+   mPlacement[2] = mPlacement[3] = 1;
+   mOffset[0] = mOffset[1] = 0;
+}
+
+DynamicTextMesh::~DynamicTextMesh()
+{
+   for (Batch& b : mBatches)
+   {
+      // the vertices and indices belong to the mesh
+      glDeleteBuffers(1, &b.pPacket->miVbo);
+      glDeleteBuffers(1, &b.pPacket->miIbo);
+      delete b.pPacket;
+   }
+}
+
+void DynamicTextMesh::SetPlacement(float x, float y, float sx, float sy)
+{
+   if ((x != mPlacement[0]) || (y != mPlacement[1]) || (sx != mPlacement[2]) ||
+       (sy != mPlacement[3]))
+   {
+      mPlacement[0] = x;
+      mPlacement[1] = y;
+      mPlacement[2] = sx;
+      mPlacement[3] = sy;
+      mbRewrite = true;
+   }
+}
+
+DynamicTextMesh::Batch& DynamicTextMesh::GetBatch(uint32_t page, FontHandle font)
+{
+   for (Batch& b : mBatches)
+   {
+      if (b.page == page)
+      {
+         return b;
+      }
+   }
+   mBatches.push_back(Batch());
+   Batch& b = mBatches.back();
+   b.page = page;
+   b.mVertices.assign(mCapacity * FLOATS_PER_SLOT, 0.0f);
+
+   b.pPacket = new RenderPacket();
+   // Init the render packet which will be passed to the scene graph on render.
+   b.pPacket->mMasterZ = 0.0f;
+   glGenBuffers(1, &b.pPacket->miVbo);
+   glGenBuffers(1, &b.pPacket->miIbo);
+   b.pPacket->miShaderProgram = ESShaderRepository::Instance().GetShaderProgram(
+      FontLibrary::instance().IsSdf(font) ? ESShaderRepository::FONT_SDF
+                                          : ESShaderRepository::FONT);
+   b.pPacket->mTransform.identity();
+   b.pPacket->mTransform[12] = mOffset[0];
+   b.pPacket->mTransform[13] = mOffset[1];
+   b.pPacket->miType = GL_TRIANGLES;
+   b.pPacket->mfUniformArray = mpColor;
+   // rewritten a few quads at a time, every frame
+   b.pPacket->miUsage = GL_STREAM_DRAW;
+
+   // shader (FONT)
+   b.pPacket->miVertArraySize = 3;
+   b.pPacket->miVertArrayOffset = 0;
+   b.pPacket->miTextureArraySize = 2;
+   b.pPacket->miTextureArrayOffset = 3;
+   b.pPacket->miColorArraySize = 0;
+   b.pPacket->miColorArrayOffset = 0;
+   b.pPacket->miVertexStride = FLOATS_PER_VERTEX * sizeof(GLfloat);
+   b.pPacket->miVertexCount = static_cast<unsigned int>(mCapacity * 4);
+   b.pPacket->mfVertices = b.mVertices.data();
+   b.pPacket->miIndexType = GL_UNSIGNED_SHORT;
+   b.pPacket->miIndexCount = 0;
+   b.pPacket->miIndexBufferCount = static_cast<unsigned int>(mIndices.size());
+   b.pPacket->mpIndices = mIndices.data();
+   return b;
+}
+
+void DynamicTextMesh::Grow(size_t count)
+{
+   mCapacity = std::min(std::max(count, std::max(mCapacity * 2, MIN_CAPACITY)), MAX_QUADS);
+
+   // the same 6 indices per slot for ever
+   mIndices.resize(mCapacity * 6);
+   for (size_t slot = 0; slot < mCapacity; slot++)
+   {
+      const uint16_t v = static_cast<uint16_t>(slot * 4);
+      uint16_t* pIndex = &mIndices[slot * 6];
+      pIndex[0] = v;
+      pIndex[1] = pIndex[4] = uint16_t(v + 1);
+      pIndex[2] = pIndex[3] = uint16_t(v + 2);
+      pIndex[5] = uint16_t(v + 3);
+   }
+
+   // new buffers, the slots are written again by the caller
+   for (Batch& b : mBatches)
+   {
+      b.mVertices.assign(mCapacity * FLOATS_PER_SLOT, 0.0f);
+      b.pPacket->miVertexCount = static_cast<unsigned int>(mCapacity * 4);
+      b.pPacket->mfVertices = b.mVertices.data();
+      b.pPacket->MarkDirty();
+      b.pPacket->miIndexBufferCount = static_cast<unsigned int>(mIndices.size());
+      b.pPacket->mpIndices = mIndices.data();
+      b.pPacket->mbIndicesDirty = true;
+   }
+   mbRewrite = true;
+}
+
+void DynamicTextMesh::WriteSlot(Batch& b, size_t slot, const GlyphQuad& q)
+{
+   // UL, UR, LL, LR
+   const float xs[2] = {mPlacement[0] + (q.x0 * mPlacement[2]),
+                        mPlacement[0] + (q.x1 * mPlacement[2])};
+   const float ys[2] = {mPlacement[1] + (q.y0 * mPlacement[3]),
+                        mPlacement[1] + (q.y1 * mPlacement[3])};
+   const float us[2] = {q.u0, q.u1};
+   const float vs[2] = {q.v0, q.v1};
+   float* pVertex = &b.mVertices[slot * FLOATS_PER_SLOT];
+   for (int corner = 0; corner < 4; corner++)
+   {
+      *pVertex++ = xs[corner & 1];
+      *pVertex++ = ys[corner >> 1];
+      *pVertex++ = 0;
+      *pVertex++ = us[corner & 1];   // U
+      *pVertex++ = vs[corner >> 1];  // V
+   }
+   b.pPacket->MarkDirty(static_cast<unsigned int>(slot * 4), 4);
+}
+
+void DynamicTextMesh::ClearSlot(Batch& b, size_t slot)
+{
+   // a degenerate quad draws nothing
+   float* pVertex = &b.mVertices[slot * FLOATS_PER_SLOT];
+   std::fill(pVertex, pVertex + FLOATS_PER_SLOT, 0.0f);
+   b.pPacket->MarkDirty(static_cast<unsigned int>(slot * 4), 4);
+}
+
+size_t DynamicTextMesh::Update(const GlyphQuad* pQuads, size_t count, FontHandle font)
+{
+   if (count > MAX_QUADS)
+   {
+      addlog(Log::L_ERROR, "Too many glyphs in one text mesh\n");
+      count = MAX_QUADS;
+   }
+   if (count > mCapacity)
+   {
+      Grow(count);
+   }
+
+   size_t changed = 0;
+   size_t shown = mQuads.size();
+   for (size_t slot = 0; slot < std::max(count, shown); slot++)
+   {
+      const GlyphQuad* pOld = (slot < shown) ? &mQuads[slot] : nullptr;
+      const GlyphQuad* pNew = (slot < count) ? &pQuads[slot] : nullptr;
+      if (pOld && pNew && !mbRewrite && SameQuad(*pOld, *pNew))
+      {
+         continue;
+      }
+      // a slot past the end is not drawn, but could be again from another page
+      if (pOld && (!pNew || (pOld->page != pNew->page)))
+      {
+         ClearSlot(GetBatch(pOld->page, font), slot);
+      }
+      if (pNew)
+      {
+         WriteSlot(GetBatch(pNew->page, font), slot, *pNew);
+         changed++;
+      }
+   }
+   mQuads.assign(pQuads, pQuads + count);
+   mbRewrite = false;
+
+   for (Batch& b : mBatches)
+   {
+      b.pPacket->miIndexCount = static_cast<unsigned int>(count * 6);
+      if (changed > 0)
+      {
+         // new glyphs may have been rasterized (atlas upload, new page)
+         b.pPacket->miTexture = FontLibrary::instance().AtlasTexture(font, b.page);
+      }
+   }
+   return changed;
+}
+
+void DynamicTextMesh::SetColor(const float* pRGBA)
+{
+   mpColor = pRGBA;
+   for (Batch& b : mBatches)
+   {
+      b.pPacket->mfUniformArray = mpColor;
+   }
+}
+
+void DynamicTextMesh::SetOffset(float dx, float dy)
+{
+   mOffset[0] = dx;
+   mOffset[1] = dy;
+   for (Batch& b : mBatches)
+   {
+      b.pPacket->mTransform[12] = dx;
+      b.pPacket->mTransform[13] = dy;
+   }
+}
+
+void DynamicTextMesh::Draw()
+{
+   for (Batch& b : mBatches)
+   {
+      if (b.pPacket->miIndexCount > 0)
+      {
+         b.pPacket->Render();
+      }
+   }
+}
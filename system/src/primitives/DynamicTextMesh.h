@@ -0,0 +1,74 @@
+#ifndef DYNAMIC_TEXT_MESH_H
+#define DYNAMIC_TEXT_MESH_H
+#include <stddef.h>
+#include <stdint.h>
+#include <vector>
+
+#include "FontLibrary.h"
+
+class RenderPacket;
+
+//! @brief FONT (or FONT_SDF) shader packets for text that changes all the time (live
+//! values, timers).
+//! @par Every glyph quad has a slot of 4 vertices in a GL_STREAM_DRAW buffer. Update()
+//! compares the new quads with the ones shown and rewrites only the slots that differ, the
+//! upload is the dirty range of the buffer: "1234" to "1235" uploads one quad. The indices
+//! are built once for all the slots, only the drawn count changes with the text length.
+//! One packet per atlas page (usually one), the slots of the glyphs on other pages are
+//! degenerate.
+class DynamicTextMesh
+{
+public:
+   DynamicTextMesh();
+   ~DynamicTextMesh();
+
+   //! @brief Where the quads go on the screen: (x + qx * sx, y + qy * sy), rewrites all
+   //! the slots on the next Update() if it changed.
+   //! @param[in] x,y Screen position of the upper left of the text.
+   //! @param[in] sx,sy Screen units per text pixel (sy < 0 when screen y is up).
+   void SetPlacement(float x, float y, float sx, float sy);
+
+   //! @brief Show new glyph quads.
+   //! @param[in] pQuads Quads from FontLibrary::BuildQuads().
+   //! @param[in] count Number of quads.
+   //! @param[in] font Font the quads were laid out with (selects the atlas).
+   //! @return size_t Number of slots rewritten.
+   size_t Update(const GlyphQuad* pQuads, size_t count, FontHandle font);
+
+   //! @brief Text color (uColor), the array must outlive the mesh.
+   void SetColor(const float* pRGBA);
+
+   //! @brief Move the whole text by its transform, the vertices are not touched.
+   void SetOffset(float dx, float dy);
+
+   void Draw();
+
+   DynamicTextMesh(const DynamicTextMesh&) = delete;
+   DynamicTextMesh& operator=(const DynamicTextMesh&) = delete;
+
+private:
+   //! @brief Slots of one atlas page.
+   struct Batch
+   {
+      uint32_t page;
+      std::vector<float> mVertices;  //!< mCapacity slots
+      RenderPacket* pPacket;
+   };
+
+   Batch& GetBatch(uint32_t page, FontHandle font);
+   //! @brief Room for count slots in every batch, all slots are rewritten after growing.
+   void Grow(size_t count);
+   void WriteSlot(Batch& b, size_t slot, const GlyphQuad& q);
+   void ClearSlot(Batch& b, size_t slot);
+
+   std::vector<Batch> mBatches;
+   std::vector<GlyphQuad> mQuads;   //!< Shown, one per slot
+   std::vector<uint16_t> mIndices;  //!< 6 per slot, shared by the batches
+   size_t mCapacity;                //!< Slots in the buffers
+   bool mbRewrite;                  //!< Placement or capacity changed, rewrite every slot
+   float mPlacement[4];             //!< x, y, sx, sy
+   const float* mpColor;
+   float mOffset[2];
+};
+
+#endif  // DYNAMIC_TEXT_MESH_H
@@ -0,0 +1,89 @@
+#include "Gradient.h"
+
+#include <algorithm>
+
+Gradient::Gradient() : mType(LINEAR)
+{
+   for (int i = 0; i < 4; i++)
+   {
+      mGeometry[i] = 0;
+   }
+   mStops.push_back({0.0f, Color(0.0f, 0.0f, 0.0f, 0.0f)});
+   mStops.push_back({1.0f, Color(0.0f, 0.0f, 0.0f, 0.0f)});
+}
+
+Gradient Gradient::Linear(float x0, float y0, float x1, float y1, const Color& c0,
+                          const Color& c1)
+{
+   Gradient g;
+   g.mType = LINEAR;
+   g.mGeometry[0] = x0;
+   g.mGeometry[1] = y0;
+   g.mGeometry[2] = x1;
+   g.mGeometry[3] = y1;
+   g.mStops[0].color = c0;
+   g.mStops[1].color = c1;
+   return g;
+}
+
+Gradient Gradient::Radial(float cx, float cy, float rx, float ry, const Color& c0,
+                          const Color& c1)
+{
+   Gradient g;
+   g.mType = RADIAL;
+   g.mGeometry[0] = cx;
+   g.mGeometry[1] = cy;
+   g.mGeometry[2] = rx;
+   g.mGeometry[3] = ry;
+   g.mStops[0].color = c0;
+   g.mStops[1].color = c1;
+   return g;
+}
+
+Gradient& Gradient::AddStop(float position, const Color& c)
+{
+   Stop s = {std::min(std::max(position, 0.0f), 1.0f), c};
+   auto it = std::upper_bound(mStops.begin(), mStops.end(), s,
+                              [](const Stop& a, const Stop& b) { return a.position < b.position; });
+   // keep the end stops last
+   if (it == mStops.end())
+      --it;
+   mStops.insert(it, s);
+   return *this;
+}
+
+void Gradient::GetParams(float* params) const
+{
+   params[0] = static_cast<float>(mType);
+   params[1] = NeedsRamp() ? 1.0f : 0.0f;
+   params[2] = 0;
+   params[3] = 0;
+   for (int i = 0; i < 4; i++)
+   {
+      params[4 + i] = mGeometry[i];
+      params[8 + i] = mStops.front().color.FloatArray()[i];
+      params[12 + i] = mStops.back().color.FloatArray()[i];
+   }
+}
+
+void Gradient::BuildRamp(uint8_t* pRGBA, int width) const
+{
+   size_t s = 0;
+   for (int x = 0; x < width; x++)
+   {
+      float t = static_cast<float>(x) / (width - 1);
+      while ((s + 2 < mStops.size()) && (t > mStops[s + 1].position))
+      {
+         s++;
+      }
+      const Stop& a = mStops[s];
+      const Stop& b = mStops[s + 1];
+      float span = b.position - a.position;
+      float k = (span > 0) ? std::min(std::max((t - a.position) / span, 0.0f), 1.0f) : 1.0f;
+      for (int c = 0; c < 4; c++)
+      {
+         float v = a.color.FloatArray()[c] + ((b.color.FloatArray()[c] - a.color.FloatArray()[c]) * k);
+         *pRGBA++ = static_cast<uint8_t>((std::min(std::max(v, 0.0f), 1.0f) * 255.0f) + 0.5f);
+      }
+   }
+}
@@ -0,0 +1,58 @@
+#pragma once
+#include <stdint.h>
+#include <vector>
+
+#include "Color.h"
+
+//! @brief Linear or radial color gradient for the GRADIENT_FILL shader.
+//! @par Coordinates are in the units of the shape vertices, which are relative to the
+//! center for the round shapes (CCircle, CFan...) and absolute for the others. Two stops
+//! are passed as uniforms, more stops are baked into a 256x1 ramp texture.
+class Gradient
+{
+public:
+   enum Type
+   {
+      LINEAR = 0,
+      RADIAL
+   };
+
+   //! @brief No gradient (transparent black to itself).
+   Gradient();
+
+   //! @brief Linear gradient, c0 at (x0, y0) to c1 at (x1, y1), constant across.
+   static Gradient Linear(float x0, float y0, float x1, float y1, const Color& c0,
+                          const Color& c1);
+   //! @brief Radial gradient, c0 at the center to c1 on the ellipse of radii (rx, ry).
+   static Gradient Radial(float cx, float cy, float rx, float ry, const Color& c0,
+                          const Color& c1);
+
+   //! @brief Add a color stop between the ends.
+   //! @param[in] position 0 (start color) to 1 (end color).
+   //! @param[in] c Color.
+   //! @return Reference to this gradient.
+   Gradient& AddStop(float position, const Color& c);
+
+   //! @brief true if the stops need the ramp texture.
+   bool NeedsRamp() const { return mStops.size() > 2; }
+
+   //! @brief Fill the uParams of GRADIENT_FILL.
+   //! @param[out] params 16 floats (4 vec4).
+   void GetParams(float* params) const;
+
+   //! @brief Sample the stops into RGBA8 texels.
+   //! @param[out] pRGBA width * 4 bytes.
+   //! @param[in] width Texels.
+   void BuildRamp(uint8_t* pRGBA, int width) const;
+
+private:
+   struct Stop
+   {
+      float position;
+      Color color;
+   };
+
+   Type mType;
+   float mGeometry[4];
+   std::vector<Stop> mStops;  //!< Sorted by position
+};
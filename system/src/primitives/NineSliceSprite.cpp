@@ -0,0 +1,106 @@
+#include "IPlatform.h"
+
+#include "glad/glad.h"
+#include <GLES2/gl2.h>
+#include <algorithm>
+
+#include "NineSliceSprite.h"
+#include "RenderPacket.h"
+
+// Two triangles for each of the 9 cells of the 4x4 vertex grid
+static const uint16_t NINE_SLICE_INDICES[54] = {
+    0,  1,  5,  0,  5,  4,  1,  2,  6,  1,  6,  5,  2,  3,  7,  2,  7,  6,
+    4,  5,  9,  4,  9,  8,  5,  6,  10, 5,  10, 9,  6,  7,  11, 6,  11, 10,
+    8,  9,  13, 8,  13, 12, 9,  10, 14, 9,  14, 13, 10, 11, 15, 10, 15, 14};
+
+NineSliceSprite::NineSliceSprite(const ScreenRect& r, const char* pImageSpec, int left, int top,
+                                 int right, int bottom)
+    : BaseSprite(r, pImageSpec)
+{
+    mInsets[0] = left;
+    mInsets[1] = top;
+    mInsets[2] = right;
+    mInsets[3] = bottom;
+}
+
+NineSliceSprite::~NineSliceSprite()
+{
+}
+
+void NineSliceSprite::Instantiate()
+{
+    LoadTexture();
+    if (!mpRenderPacket)
+    {
+        CreatePacket(GL_TRIANGLES, 16);
+        glGenBuffers(1, &mpRenderPacket->miIbo);
+        mpRenderPacket->miIndexType = GL_UNSIGNED_SHORT;
+        mpRenderPacket->miIndexCount = 54;
+        mpRenderPacket->mpIndices = NINE_SLICE_INDICES;
+    }
+    LoadVertexData();
+}
+
+void NineSliceSprite::SetInsets(int left, int top, int right, int bottom)
+{
+    mInsets[0] = left;
+    mInsets[1] = top;
+    mInsets[2] = right;
+    mInsets[3] = bottom;
+    LoadVertexData();
+}
+
+void NineSliceSprite::LoadVertexData()
+{
+    if (!mpRenderPacket || (w <= 0) || (h <= 0))
+    {
+        return;
+    }
+
+    // border sizes on screen, texture pixels drawn at the same scale as a BaseSprite,
+    // shrunk if the sprite is smaller than its two borders
+    ScreenRect r = SnappedScreen();
+    float left = mInsets[0] * TexelWidth();
+    float right = mInsets[2] * TexelWidth();
+    float top = mInsets[1] * TexelHeight();
+    float bottom = mInsets[3] * TexelHeight();
+    float fx = std::min(1.0f, r.w / std::max(left + right, 0.000001f));
+    float fy = std::min(1.0f, r.h / std::max(top + bottom, 0.000001f));
+    float down = Down();
+
+    const float xs[4] = {r.x, r.x + (left * fx), r.x + r.w - (right * fx), r.x + r.w};
+    const float ys[4] = {r.y, r.y + (down * top * fy), r.y + (down * (r.h - (bottom * fy))),
+                         r.y + (down * r.h)};
+    const float us[4] = {0, static_cast<float>(mInsets[0]) / w, 1.0f - (static_cast<float>(mInsets[2]) / w), 1};
+    const float vs[4] = {0, static_cast<float>(mInsets[1]) / h, 1.0f - (static_cast<float>(mInsets[3]) / h), 1};
+
+    const float* c0 = mColors[0].FloatArray();
+    const float* c1 = mColors[1].FloatArray();
+    const float* c2 = mColors[2].FloatArray();
+    const float* c3 = mColors[3].FloatArray();
+    float dz = 0.0f;
+    int vi = 0;
+    for (int row = 0; row < 4; row++)
+    {
+        for (int col = 0; col < 4; col++)
+        {
+            // corner colors (UL, UR, LL, LR) blended across the panel
+            float cx = (xs[col] - r.x) / std::max(r.w, 0.000001f);
+            float cy = (down * (ys[row] - r.y)) / std::max(r.h, 0.000001f);
+
+            mpRenderPacket->mfVertices[vi++] = xs[col];
+            mpRenderPacket->mfVertices[vi++] = ys[row];
+            mpRenderPacket->mfVertices[vi++] = dz;
+            mpRenderPacket->mfVertices[vi++] = us[col];  // U
+            mpRenderPacket->mfVertices[vi++] = vs[row];  // V
+            for (int i = 0; i < 4; i++)  // RGBA
+            {
+                float upper = c0[i] + ((c1[i] - c0[i]) * cx);
+                float lower = c2[i] + ((c3[i] - c2[i]) * cx);
+                mpRenderPacket->mfVertices[vi++] = upper + ((lower - upper) * cy);
+            }
+        }
+    }
+
+    mpRenderPacket->MarkDirty();
+}
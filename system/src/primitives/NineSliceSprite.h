@@ -0,0 +1,31 @@
+#ifndef NINE_SLICE_SPRITE_H
+#define NINE_SLICE_SPRITE_H
+#include "BaseSprite.h"
+
+//! @brief Sprite drawn with fixed size corners, edges stretched in one direction and the
+//! center stretched in both, so a small texture can cover a panel of any size.
+//! @par Drawn as a single indexed mesh of 16 vertices (4x4 grid, 9 quads).
+class NineSliceSprite : public BaseSprite
+{
+   public:
+    //! @brief Constructor
+    //! @param[in] r Screen location, 0 width/height use the image size.
+    //! @param[in] pImageSpec Image file.
+    //! @param[in] left,top,right,bottom Size of the fixed borders in texture pixels.
+    NineSliceSprite(const ScreenRect& r, const char* pImageSpec, int left, int top, int right,
+                    int bottom);
+    virtual ~NineSliceSprite();
+
+    virtual void Instantiate() override;
+
+    //! @brief Change the borders. Rewrites the vertices in place.
+    //! @param[in] left,top,right,bottom Size of the fixed borders in texture pixels.
+    void SetInsets(int left, int top, int right, int bottom);
+
+   protected:
+    virtual void LoadVertexData() override;
+
+    int mInsets[4];  //!< left, top, right, bottom in texture pixels
+};
+
+#endif  // NINE_SLICE_SPRITE_H
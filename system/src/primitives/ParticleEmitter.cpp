@@ -0,0 +1,311 @@
+#include "glad/glad.h"
+#include <GLFW/glfw3.h>  // Includes <GLES2/gl2.h>
+
+#include <algorithm>
+#include <cmath>
+
+#include "ESShaderRepository.h"
+#include "IPlatform.h"
+#include "ParticleEmitter.h"
+#include "RenderPacket.h"
+
+constexpr float DEG2RAD = 0.0174533f;
+// 3 floats for the pos, 4 for color (COLOR_FILL)
+constexpr unsigned int FLOATS_PER_VERTEX = 7;
+// Longest step simulated at once (after a stall)
+constexpr float MAX_STEP = 0.1f;
+
+ParticleEmitter::ParticleEmitter(float x, float y, unsigned int capacity)
+   : IPrimitive(),
+     miCapacity(capacity),
+     miCount(0),
+     mx0(x),
+     my0(y),
+     mfRate(100.0f),
+     mfEmitDebt(0),
+     mfAngle(90.0f),
+     mfSpread(30.0f),
+     mfSpeedMin(0.2f),
+     mfSpeedMax(0.4f),
+     mfLifeMin(1.0f),
+     mfLifeMax(2.0f),
+     mfSizeStart(0.01f),
+     mfSizeEnd(0.0f),
+     mfGravityX(0),
+     mfGravityY(0),
+     mLastTime(-1),
+     mSeed(0x9E3779B9)
+{
+   mX.resize(capacity);
+   mY.resize(capacity);
+   mVX.resize(capacity);
+   mVY.resize(capacity);
+   mAge.resize(capacity);
+   mInvLife.resize(capacity);
+   SetColors(Color(1.0f, 1.0f, 0.0f), Color(1.0f, 0.0f, 0.0f, 0.0f));
+}
+
+ParticleEmitter::~ParticleEmitter()
+{
+   if (mpRenderPacket)
+   {
+      glDeleteBuffers(1, &mpRenderPacket->miVbo);
+      glDeleteBuffers(1, &mpRenderPacket->miIbo);
+      delete[] mpRenderPacket->mfVertices;
+      delete mpRenderPacket;
+   }
+}
+
+void ParticleEmitter::SetPosition(float x, float y)
+{
+   mx0 = x;
+   my0 = y;
+}
+
+void ParticleEmitter::SetDirection(float angle, float spread)
+{
+   mfAngle = angle;
+   mfSpread = spread;
+}
+
+void ParticleEmitter::SetSpeed(float min, float max)
+{
+   mfSpeedMin = min;
+   mfSpeedMax = max;
+}
+
+void ParticleEmitter::SetLifetime(float min, float max)
+{
+   mfLifeMin = std::max(min, 0.001f);
+   mfLifeMax = std::max(max, mfLifeMin);
+}
+
+void ParticleEmitter::SetSize(float start, float end)
+{
+   mfSizeStart = start;
+   mfSizeEnd = end;
+}
+
+void ParticleEmitter::SetColors(const Color& start, const Color& end)
+{
+   for (int i = 0; i < 4; i++)
+   {
+      mfColorStart[i] = start.FloatArray()[i];
+      mfColorEnd[i] = end.FloatArray()[i];
+   }
+}
+
+void ParticleEmitter::SetGravity(float gx, float gy)
+{
+   mfGravityX = gx;
+   mfGravityY = gy;
+}
+
+float ParticleEmitter::Random()
+{
+   // xorshift32
+   mSeed ^= mSeed << 13;
+   mSeed ^= mSeed >> 17;
+   mSeed ^= mSeed << 5;
+   return (mSeed >> 8) * (1.0f / 16777216.0f);
+}
+
+void ParticleEmitter::Burst(unsigned int count)
+{
+   Emit(count);
+}
+
+void ParticleEmitter::Emit(unsigned int count)
+{
+   count = std::min(count, miCapacity - miCount);
+   for (unsigned int i = miCount; i < miCount + count; i++)
+   {
+      float angle = (mfAngle + (mfSpread * (Random() - 0.5f))) * DEG2RAD;
+      float speed = mfSpeedMin + ((mfSpeedMax - mfSpeedMin) * Random());
+      mX[i] = mx0;
+      mY[i] = my0;
+      mVX[i] = cosf(angle) * speed;
+      mVY[i] = sinf(angle) * speed;
+      mAge[i] = 0;
+      mInvLife[i] = 1.0f / (mfLifeMin + ((mfLifeMax - mfLifeMin) * Random()));
+   }
+   miCount += count;
+}
+
+void ParticleEmitter::Update(float dt)
+{
+   dt = std::min(dt, MAX_STEP);
+
+   // integrate, one attribute per loop so the compiler can vectorize
+   unsigned int n = miCount;
+   float* x = mX.data();
+   float* y = mY.data();
+   float* vx = mVX.data();
+   float* vy = mVY.data();
+   float* age = mAge.data();
+   float gx = mfGravityX * dt;
+   float gy = mfGravityY * dt;
+   for (unsigned int i = 0; i < n; i++)
+   {
+      vx[i] += gx;
+      vy[i] += gy;
+   }
+   for (unsigned int i = 0; i < n; i++)
+   {
+      x[i] += vx[i] * dt;
+      y[i] += vy[i] * dt;
+   }
+   for (unsigned int i = 0; i < n; i++)
+   {
+      age[i] += dt;
+   }
+
+   // remove the dead by moving the last living particle into their slot
+   const float* invLife = mInvLife.data();
+   for (unsigned int i = 0; i < n;)
+   {
+      if ((age[i] * invLife[i]) >= 1.0f)
+      {
+         n--;
+         x[i] = x[n];
+         y[i] = y[n];
+         vx[i] = vx[n];
+         vy[i] = vy[n];
+         age[i] = age[n];
+         mInvLife[i] = mInvLife[n];
+      }
+      else
+      {
+         i++;
+      }
+   }
+   miCount = n;
+
+   // continuous emission
+   mfEmitDebt += mfRate * dt;
+   unsigned int count = static_cast<unsigned int>(mfEmitDebt);
+   mfEmitDebt -= count;
+   Emit(count);
+}
+
+void ParticleEmitter::Instantiate()
+{
+   if (mpRenderPacket || (miCapacity == 0))
+   {
+      return;
+   }
+
+   mpRenderPacket = new RenderPacket();
+   // Init the render packet which will be passed to the scene graph on render.
+   mpRenderPacket->mMasterZ = 0.0f;
+   mpRenderPacket->miTexture = 0;
+   glGenBuffers(1, &mpRenderPacket->miVbo);
+   mpRenderPacket->miShaderProgram =
+      ESShaderRepository::Instance().GetShaderProgram(ESShaderRepository::COLOR_FILL);
+   mpRenderPacket->mTransform.identity();
+   mpRenderPacket->mbPixelSpace = mbPixelSpace;
+   mpRenderPacket->miType = GL_TRIANGLES;
+
+   // shader (COLOR_FILL)
+   mpRenderPacket->miVertArraySize = 3;
+   mpRenderPacket->miVertArrayOffset = 0;
+   mpRenderPacket->miTextureArraySize = 0;
+   mpRenderPacket->miTextureArrayOffset = 0;
+   mpRenderPacket->miColorArraySize = 4;
+   mpRenderPacket->miColorArrayOffset = 3;
+   mpRenderPacket->miVertexStride = FLOATS_PER_VERTEX * sizeof(GLfloat);
+
+   // buffer for the capacity, rewritten every frame up to the living particles
+   mpRenderPacket->miUsage = GL_STREAM_DRAW;
+   mpRenderPacket->miVertexCount = miCapacity * 4;
+   mpRenderPacket->mfVertices = new float[miCapacity * 4 * FLOATS_PER_VERTEX];
+   std::fill(mpRenderPacket->mfVertices, mpRenderPacket->mfVertices + (miCapacity * 4 * FLOATS_PER_VERTEX), 0.0f);
+
+   // two triangles per quad, uploaded once
+   mIndices.resize(miCapacity * 6);
+   for (uint32_t i = 0; i < miCapacity; i++)
+   {
+      uint32_t v = i * 4;
+      uint32_t* p = &mIndices[i * 6];
+      p[0] = v;
+      p[1] = v + 1;
+      p[2] = v + 2;
+      p[3] = v + 2;
+      p[4] = v + 1;
+      p[5] = v + 3;
+   }
+   glGenBuffers(1, &mpRenderPacket->miIbo);
+   mpRenderPacket->miIndexType = GL_UNSIGNED_INT;
+   mpRenderPacket->mpIndices = mIndices.data();
+   mpRenderPacket->miIndexBufferCount = miCapacity * 6;
+   mpRenderPacket->miIndexCount = 0;
+}
+
+void ParticleEmitter::LoadVertexData()
+{
+   float* pv = mpRenderPacket->mfVertices;
+   const float* x = mX.data();
+   const float* y = mY.data();
+   const float* age = mAge.data();
+   const float* invLife = mInvLife.data();
+   float dSize = mfSizeEnd - mfSizeStart;
+   float dColor[4];
+   for (int c = 0; c < 4; c++)
+   {
+      dColor[c] = mfColorEnd[c] - mfColorStart[c];
+   }
+
+   // clip space x units are narrower on a wide screen, keep the quads square
+   float aspect = 1.0f;
+   if (!mbPixelSpace)
+   {
+      IPlatform& rPlatform = IPlatform::instance();
+      aspect = static_cast<float>(rPlatform.ScreenPixelHeight()) / rPlatform.ScreenPixelWidth();
+   }
+
+   // UL, UR, LL, LR of each particle
+   static const float corners[4][2] = {{-1, 1}, {1, 1}, {-1, -1}, {1, -1}};
+   for (unsigned int i = 0; i < miCount; i++)
+   {
+      float t = age[i] * invLife[i];
+      float half = (mfSizeStart + (dSize * t)) * 0.5f;
+      float r = mfColorStart[0] + (dColor[0] * t);
+      float g = mfColorStart[1] + (dColor[1] * t);
+      float b = mfColorStart[2] + (dColor[2] * t);
+      float a = mfColorStart[3] + (dColor[3] * t);
+      for (int k = 0; k < 4; k++)
+      {
+         *pv++ = x[i] + (corners[k][0] * half * aspect);
+         *pv++ = y[i] + (corners[k][1] * half);
+         *pv++ = 0;
+         *pv++ = r;
+         *pv++ = g;
+         *pv++ = b;
+         *pv++ = a;
+      }
+   }
+
+   mpRenderPacket->miIndexCount = miCount * 6;
+   mpRenderPacket->MarkDirty(0, miCount * 4);
+}
+
+void ParticleEmitter::Draw()
+{
+   if (!mpRenderPacket)
+   {
+      return;
+   }
+
+   double now = IPlatform::instance().CurrentTime();
+   if (mLastTime >= 0)
+   {
+      Update(static_cast<float>(now - mLastTime));
+   }
+   mLastTime = now;
+
+   if (miCount > 0)
+   {
+      LoadVertexData();
+      mpRenderPacket->Render();
+   }
+}
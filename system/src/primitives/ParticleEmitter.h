@@ -0,0 +1,78 @@
+#pragma once
+#include <stdint.h>
+#include <vector>
+#include <IPrimitive.h>
+#include "Color.h"
+
+//! @brief Emits and draws many small colored quads (particles) as one primitive.
+//! @par Particles are stored as structure of arrays (one float array per attribute) and
+//! updated by straight loops over them. All living particles are written into one streamed
+//! vertex buffer and drawn by a single indexed call; the buffer and the index list are sized
+//! once for the capacity.
+class ParticleEmitter : public IPrimitive
+{
+public:
+   //! @brief Constructor
+   //! @param[in] x,y Emission point.
+   //! @param[in] capacity Maximum number of living particles.
+   ParticleEmitter(float x, float y, unsigned int capacity);
+   virtual ~ParticleEmitter();
+
+   virtual void Instantiate() override;
+   //! @brief Advance the particles to the current time (IPlatform::CurrentTime()), then draw.
+   virtual void Draw() override;
+
+   //! @brief Move the emission point (living particles stay where they are).
+   void SetPosition(float x, float y);
+   //! @brief Particles emitted per second (0 for bursts only).
+   void SetRate(float perSecond) { mfRate = perSecond; }
+   //! @brief Emission direction and spread, in degrees.
+   void SetDirection(float angle, float spread);
+   //! @brief Initial speed range, in units per second.
+   void SetSpeed(float min, float max);
+   //! @brief Lifetime range in seconds.
+   void SetLifetime(float min, float max);
+   //! @brief Quad size at birth and at death, in y units (the quads are square on screen).
+   void SetSize(float start, float end);
+   //! @brief Color at birth and at death.
+   void SetColors(const Color& start, const Color& end);
+   //! @brief Constant acceleration, in units per second squared.
+   void SetGravity(float gx, float gy);
+
+   //! @brief Emit count particles now.
+   void Burst(unsigned int count);
+   //! @brief Advance the simulation (done by Draw()).
+   //! @param[in] dt Seconds since the last update.
+   void Update(float dt);
+
+   unsigned int Count() const { return miCount; }
+
+private:
+   void Emit(unsigned int count);
+   void LoadVertexData();
+   //! @brief Uniform random number in [0, 1)
+   float Random();
+
+   // particle attributes (structure of arrays)
+   std::vector<float> mX, mY;
+   std::vector<float> mVX, mVY;
+   std::vector<float> mAge;      //!< Seconds since birth
+   std::vector<float> mInvLife;  //!< 1 / lifetime
+   unsigned int miCapacity;
+   unsigned int miCount;
+
+   // emitter settings
+   float mx0, my0;
+   float mfRate;
+   float mfEmitDebt;  //!< Fraction of a particle left to emit
+   float mfAngle, mfSpread;
+   float mfSpeedMin, mfSpeedMax;
+   float mfLifeMin, mfLifeMax;
+   float mfSizeStart, mfSizeEnd;
+   float mfColorStart[4], mfColorEnd[4];
+   float mfGravityX, mfGravityY;
+
+   std::vector<uint32_t> mIndices;
+   double mLastTime;  //!< Negative before the first Draw()
+   uint32_t mSeed;
+};
@@ -0,0 +1,73 @@
+#pragma once
+#include <stdint.h>
+
+//! @brief Layout of the binary scene files written by SceneCompiler and read by SceneLoader.
+//! @par The file is used in place through a memory mapping, so every table is an array of
+//! fixed size, 4 byte aligned records in native byte order (floats already converted):
+//! SceneHeader, SceneStyle[styleCount], SceneRecord[recordCount], then the string pool
+//! (zero terminated UTF-8 strings referenced by byte offset).
+namespace SceneFormat
+{
+   constexpr uint32_t MAGIC = 0x4E435347;  //!< "GSCN"
+   constexpr uint32_t VERSION = 1;
+   constexpr uint32_t NO_STYLE = 0xFFFFFFFF;  //!< Record uses the class default style
+   constexpr uint32_t MIN_SIDES = 3;          //!< Sides of the round shapes (count)
+   constexpr uint32_t MAX_SIDES = 4096;
+
+   //! @brief Record types, one per primitive class
+   enum Type : uint16_t
+   {
+      LINE = 0,      //!< f[0..3] end points, f[4] width
+      CIRCLE,        //!< f[0..1] center, f[2] radius, count sides
+      CIRCLE_LINE,   //!< f[0..1] center, f[2] radius, count sides
+      FAN_LINE,      //!< f[0..1] center, f[2] radius, f[3..4] start/stop angle, count sides
+      FAN,           //!< f[0..1] center, f[2] radius, f[3..4] start/stop angle, count sides
+      ROUND_RECT,    //!< f[0..3] corners, f[4] width, FILLED flag
+      SPRITE,        //!< f[0..3] screen rect, text image spec
+      TEXT,          //!< f[0..3] screen rect, text font spec, text2 content
+      TYPE_COUNT
+   };
+
+   //! @brief Record flags
+   enum Flags : uint16_t
+   {
+      SDF = 0x01,        //!< CShape::SetSdf()
+      ANTIALIAS = 0x02,  //!< CShape::SetAntialias()
+      FILLED = 0x04      //!< CRoundRectangle panel
+   };
+
+   struct SceneHeader
+   {
+      uint32_t magic;
+      uint32_t version;
+      uint32_t styleCount;
+      uint32_t recordCount;
+      uint32_t styleOffset;   //!< Byte offset of the style table
+      uint32_t recordOffset;  //!< Byte offset of the record table
+      uint32_t stringOffset;  //!< Byte offset of the string pool
+      uint32_t stringBytes;   //!< Size of the string pool
+   };
+
+   struct SceneStyle
+   {
+      float fill[4];
+      float stroke[4];
+      float strokeWidth;
+      float opacity;
+   };
+
+   struct SceneRecord
+   {
+      uint16_t type;   //!< Type
+      uint16_t flags;  //!< Flags
+      uint32_t style;  //!< Index in the style table or NO_STYLE
+      float f[6];      //!< Geometry, see Type
+      uint32_t count;  //!< Sides, MIN_SIDES to MAX_SIDES
+      uint32_t text;   //!< String pool offset
+      uint32_t text2;  //!< String pool offset
+   };
+
+   static_assert(sizeof(SceneHeader) == 32, "SceneHeader layout");
+   static_assert(sizeof(SceneStyle) == 40, "SceneStyle layout");
+   static_assert(sizeof(SceneRecord) == 44, "SceneRecord layout");
+}
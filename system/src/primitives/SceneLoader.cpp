@@ -0,0 +1,133 @@
+#include "SceneLoader.h"
+
+#include "BaseSprite.h"
+#include "Log.h"
+#include "SceneFormat.h"
+#include "ShapeDrawing.h"
+
+using namespace SceneFormat;
+
+// Build a Style from its file record
+static Style MakeStyle(const SceneStyle& s)
+{
+   return Style(Color(s.fill[0], s.fill[1], s.fill[2], s.fill[3]),
+                Color(s.stroke[0], s.stroke[1], s.stroke[2], s.stroke[3]), s.strokeWidth,
+                s.opacity);
+}
+
+// Create a shape with the record style, or with its class default style
+template <class T, class... Args>
+static T* MakeShape(const Style* pStyle, Args... args)
+{
+   if (pStyle)
+      return new T(args..., *pStyle);
+   return new T(args...);
+}
+
+bool SceneLoader::Load(const char* pFileName, std::vector<IPrimitive*>& scene, bool bInstantiate)
+{
+   MappedFile file;
+   if (!file.Open(pFileName))
+   {
+      return false;
+   }
+
+   // validate the tables before using them in place
+   const uint8_t* pData = file.Data();
+   size_t size = file.Size();
+   const SceneHeader* pHeader = reinterpret_cast<const SceneHeader*>(pData);
+   if ((size < sizeof(SceneHeader)) || (pHeader->magic != MAGIC) ||
+       (pHeader->version != VERSION))
+   {
+      addlog(Log::L_ERROR, "%s is not a version %u scene", pFileName, VERSION);
+      return false;
+   }
+   if ((pHeader->styleOffset + (uint64_t(pHeader->styleCount) * sizeof(SceneStyle)) > size) ||
+       (pHeader->recordOffset + (uint64_t(pHeader->recordCount) * sizeof(SceneRecord)) > size) ||
+       (uint64_t(pHeader->stringOffset) + pHeader->stringBytes > size) ||
+       ((pHeader->styleOffset | pHeader->recordOffset) & 3) ||
+       ((pHeader->stringBytes > 0) && (pData[pHeader->stringOffset + pHeader->stringBytes - 1] != 0)))
+   {
+      addlog(Log::L_ERROR, "%s is truncated", pFileName);
+      return false;
+   }
+   const SceneStyle* pStyles = reinterpret_cast<const SceneStyle*>(pData + pHeader->styleOffset);
+   const SceneRecord* pRecords =
+      reinterpret_cast<const SceneRecord*>(pData + pHeader->recordOffset);
+   const char* pStrings = reinterpret_cast<const char*>(pData + pHeader->stringOffset);
+
+   std::vector<Style> styles;
+   styles.reserve(pHeader->styleCount);
+   for (uint32_t i = 0; i < pHeader->styleCount; i++)
+   {
+      styles.push_back(MakeStyle(pStyles[i]));
+   }
+
+   size_t first = scene.size();
+   scene.reserve(first + pHeader->recordCount);
+   for (uint32_t i = 0; i < pHeader->recordCount; i++)
+   {
+      const SceneRecord& r = pRecords[i];
+      const Style* pStyle = (r.style < styles.size()) ? &styles[r.style] : nullptr;
+      const float* f = r.f;
+      bool bTextValid = (r.text < pHeader->stringBytes);
+      if ((r.type >= CIRCLE) && (r.type <= FAN) &&
+          ((r.count < MIN_SIDES) || (r.count > MAX_SIDES)))
+      {
+         addlog(Log::L_ERROR, "%s: record %u skipped, %u sides", pFileName, i, r.count);
+         continue;
+      }
+      CShape* pShape = nullptr;
+      switch (r.type)
+      {
+         case LINE:
+            pShape = MakeShape<CLine>(pStyle, f[0], f[1], f[2], f[3], f[4]);
+            break;
+         case CIRCLE:
+            pShape = MakeShape<CCircle>(pStyle, f[0], f[1], f[2], int(r.count));
+            break;
+         case CIRCLE_LINE:
+            pShape = MakeShape<CCircleLine>(pStyle, f[0], f[1], f[2], int(r.count));
+            break;
+         case FAN_LINE:
+            pShape = MakeShape<CFanLine>(pStyle, f[0], f[1], f[2], int(r.count), f[3], f[4]);
+            break;
+         case FAN:
+            pShape = MakeShape<CFan>(pStyle, f[0], f[1], f[2], int(r.count), f[3], f[4]);
+            break;
+         case ROUND_RECT:
+            pShape = MakeShape<CRoundRectangle>(pStyle, f[0], f[1], f[2], f[3], f[4],
+                                                (r.flags & FILLED) != 0);
+            break;
+         case SPRITE:
+            if (bTextValid)
+            {
+               scene.push_back(new BaseSprite({f[0], f[1], f[2], f[3]}, pStrings + r.text));
+            }
+            break;
+         case TEXT:
+            // VisualText is a BaxGUI visual and needs a parent Widget
+            addlog(Log::L_INFO, "%s: text record %u skipped, no widget to attach to",
+                   pFileName, i);
+            break;
+         default:
+            addlog(Log::L_ERROR, "%s: unknown record type %u", pFileName, r.type);
+            break;
+      }
+      if (pShape)
+      {
+         pShape->SetSdf((r.flags & SDF) != 0);
+         pShape->SetAntialias((r.flags & ANTIALIAS) != 0);
+         scene.push_back(pShape);
+      }
+   }
+
+   if (bInstantiate)
+   {
+      for (size_t i = first; i < scene.size(); i++)
+      {
+         scene[i]->Instantiate();
+      }
+   }
+   return true;
+}
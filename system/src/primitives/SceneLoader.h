@@ -0,0 +1,20 @@
+#pragma once
+#include <vector>
+
+#include "MappedFile.h"
+class IPrimitive;
+
+//! @brief Creates the primitives described by a binary scene file (see SceneFormat.h).
+//! @par The file is memory mapped and the records are used in place, no text is parsed at
+//! startup. All primitives are constructed first, then instantiated in one pass.
+class SceneLoader
+{
+public:
+   //! @brief Load a scene
+   //! @param[in] pFileName Binary scene written by SceneCompiler
+   //! @param[out] scene Created primitives are appended, the caller owns them
+   //! @param[in] bInstantiate true to also Instantiate() the new primitives
+   //! @return bool true for success, false for fail (error in log)
+   static bool Load(const char* pFileName, std::vector<IPrimitive*>& scene,
+                    bool bInstantiate = true);
+};
@@ -1,18 +1,266 @@
 #include "glad/glad.h"
 #include <GLFW/glfw3.h>  // Includes <GLES2/gl2.h>
 
+#include <algorithm>
+
 #include "ESShaderRepository.h"
+#include "IPlatform.h"
+#include "Log.h"
 #include "RenderPacket.h"
 #include "Vectors.h"
 #include "ShapeDrawing.h"
+#include "ShapeMesh.h"
+#include "Triangulator.h"
 
 constexpr double PI = 3.14159265359;
 constexpr double TWOPI = PI * 2;
 constexpr double DEG2RAD = 0.0174533;
 
-CLine::CLine(float tx0, float ty0, float tx1, float ty1, float tfWidth) : IPrimitive(), 
-   x0(tx0), y0(ty0), x1(tx1), y1(ty1), fWidth(tfWidth)
+// The vertex colors only carry coverage (antialiasing alpha), the shape color is uColor
+static const float WHITE[4] = {1, 1, 1, 1};
+
+// Store one COLOR_FILL vertex and advance the float index
+static inline void PutVertex(float* pv, int& vi, float x, float y, const float* rgba)
+{
+   pv[vi++] = x;
+   pv[vi++] = y;
+   pv[vi++] = 0;
+   pv[vi++] = rgba[0];  // R
+   pv[vi++] = rgba[1];  // G
+   pv[vi++] = rgba[2];  // B
+   pv[vi++] = rgba[3];  // A
+}
+
+// Boundary vertices of every loop (AddLoop), then the triangles on them
+static void AddPolygon(ShapeMesh& mesh, const std::vector<Vector2>& points,
+                       const std::vector<int>& loopSizes, const std::vector<uint16_t>& triangles)
+{
+   std::vector<uint16_t> remap(points.size());
+   int first = 0;
+   for (size_t k = 0; k < loopSizes.size(); k++)
+   {
+      int n = loopSizes[k];
+      uint16_t v = mesh.AddLoop(&points[first], n, WHITE, k > 0);
+      for (int i = 0; i < n; i++)
+      {
+         remap[first + i] = v + i;
+      }
+      first += n;
+   }
+   for (size_t i = 0; i < triangles.size(); i += 3)
+   {
+      mesh.AddTriangle(remap[triangles[i]], remap[triangles[i + 1]], remap[triangles[i + 2]]);
+   }
+}
+
+/*******************************************/
+CShape::CShape(const Style& style, bool bStroked)
+   : IPrimitive(),
+     mbSdf(false),
+     mbAntialias(false),
+     mbStroked(bStroked),
+     mbUsesWidth(bStroked),
+     mStyle(style),
+     mbGradient(false),
+     miGradientTexture(0)
+{
+   mpRenderPacket = nullptr;
+   for (int i = 0; i < 8; i++)
+   {
+      mfSdfParams[i] = 0;
+   }
+   UpdateColor();
+}
+
+CShape::~CShape()
+{
+   ReleasePacket();
+   if (miGradientTexture)
+      glDeleteTextures(1, &miGradientTexture);
+}
+
+void CShape::ReleasePacket()
+{
+   if (mpRenderPacket)
+   {
+      glDeleteBuffers(1, &mpRenderPacket->miVbo);
+      if (mpRenderPacket->miIbo)
+         glDeleteBuffers(1, &mpRenderPacket->miIbo);
+      delete[] mpRenderPacket->mfVertices;
+      delete mpRenderPacket;
+      mpRenderPacket = nullptr;
+   }
+}
+
+bool CShape::ReusePacket(unsigned int program, unsigned int type, int vertexCount)
+{
+   if (!mpRenderPacket)
+      return false;
+
+   if ((mpRenderPacket->miShaderProgram == program) && (mpRenderPacket->miType == type) &&
+       (mpRenderPacket->miVertexCount == static_cast<unsigned int>(vertexCount)))
+   {
+      // same layout, the caller rewrites the vertices in place
+      mpRenderPacket->MarkDirty();
+      return true;
+   }
+
+   // layout changed, start over
+   ReleasePacket();
+   return false;
+}
+
+void CShape::SetTranslation(float x, float y)
+{
+   if (mbPixelSpace)
+   {
+      x = floorf(x + 0.5f);
+      y = floorf(y + 0.5f);
+   }
+   if (!mpRenderPacket)
+      return;
+   mpRenderPacket->mTransform[12] = x;
+   mpRenderPacket->mTransform[13] = y;
+}
+
+float CShape::SnapCenter(float c, float width) const
+{
+   if (!mbPixelSpace)
+      return c;
+   // odd widths cover whole pixels when centered on a pixel center
+   int w = std::max(1, static_cast<int>(width + 0.5f));
+   return (w & 1) ? floorf(c) + 0.5f : floorf(c + 0.5f);
+}
+
+void CShape::UpdateColor()
+{
+   // a gradient replaces the color, only the opacity is left
+   const Color& c = mbGradient ? Color(1.0f, 1.0f) : (mbStroked ? mStyle.stroke : mStyle.fill);
+   mfColor[0] = c.Red();
+   mfColor[1] = c.Green();
+   mfColor[2] = c.Blue();
+   mfColor[3] = c.Alpha() * mStyle.opacity;
+}
+
+void CShape::SetColor(const Color& c)
+{
+   // uColor points at mfColor, nothing to upload but the uniform
+   if (mbStroked)
+      mStyle.stroke = c;
+   else
+      mStyle.fill = c;
+   UpdateColor();
+}
+
+void CShape::SetGradient(const Gradient& g)
+{
+   mbGradient = true;
+   mGradient = g;
+   mGradient.GetParams(mfGradientParams);
+   if (mGradient.NeedsRamp())
+   {
+      // 256 texels are enough for any stop list, only the texels change afterwards
+      const int RAMP_WIDTH = 256;
+      uint8_t ramp[RAMP_WIDTH * 4];
+      mGradient.BuildRamp(ramp, RAMP_WIDTH);
+      glActiveTexture(GL_TEXTURE0);
+      if (!miGradientTexture)
+      {
+         glGenTextures(1, &miGradientTexture);
+         glBindTexture(GL_TEXTURE_2D, miGradientTexture);
+         glTexImage2D(GL_TEXTURE_2D, 0, GL_RGBA, RAMP_WIDTH, 1, 0, GL_RGBA, GL_UNSIGNED_BYTE, ramp);
+         glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MIN_FILTER, GL_LINEAR);
+         glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MAG_FILTER, GL_LINEAR);
+         glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_WRAP_S, GL_CLAMP_TO_EDGE);
+         glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_WRAP_T, GL_CLAMP_TO_EDGE);
+      }
+      else
+      {
+         glBindTexture(GL_TEXTURE_2D, miGradientTexture);
+         glTexSubImage2D(GL_TEXTURE_2D, 0, 0, 0, RAMP_WIDTH, 1, GL_RGBA, GL_UNSIGNED_BYTE, ramp);
+      }
+      glBindTexture(GL_TEXTURE_2D, 0);
+   }
+   UpdateColor();
+   ApplyGradient();
+}
+
+void CShape::ClearGradient()
+{
+   mbGradient = false;
+   UpdateColor();
+   ApplyGradient();
+}
+
+void CShape::ApplyGradient()
+{
+   ESShaderRepository& rShaders = ESShaderRepository::Instance();
+   unsigned int fill = rShaders.GetShaderProgram(ESShaderRepository::COLOR_FILL);
+   unsigned int gradient = rShaders.GetShaderProgram(ESShaderRepository::GRADIENT_FILL);
+   if (!mpRenderPacket || ((mpRenderPacket->miShaderProgram != fill) &&
+                           (mpRenderPacket->miShaderProgram != gradient)))
+      return;  // not instantiated yet, or SDF
+
+   // same vertex layout, only the program and its uniforms differ
+   if (mbGradient)
+   {
+      mpRenderPacket->miShaderProgram = gradient;
+      mpRenderPacket->mfParamArray = mfGradientParams;
+      mpRenderPacket->miParamCount = 4;
+      mpRenderPacket->miTexture = mGradient.NeedsRamp() ? miGradientTexture : 0;
+   }
+   else
+   {
+      mpRenderPacket->miShaderProgram = fill;
+      mpRenderPacket->mfParamArray = nullptr;
+      mpRenderPacket->miParamCount = 0;
+      mpRenderPacket->miTexture = 0;
+   }
+}
+
+void CShape::SetOpacity(float opacity)
+{
+   mStyle.opacity = opacity;
+   UpdateColor();
+}
+
+void CShape::SetStyle(const Style& style)
+{
+   bool bWidthChanged = (style.strokeWidth != mStyle.strokeWidth);
+   mStyle = style;
+   UpdateColor();
+
+   // only the geometry of outlines (and round rectangle panels) depends on the style
+   if (bWidthChanged && mbUsesWidth && mpRenderPacket)
+      Instantiate();
+}
+
+void CShape::PixelSize(float& px, float& py) const
+{
+   if (mbPixelSpace)
+   {
+      px = py = 1.0f;
+      return;
+   }
+   // clip space spans 2 units across the screen
+   IPlatform& rPlatform = IPlatform::instance();
+   px = 2.0f / rPlatform.ScreenPixelWidth();
+   py = 2.0f / rPlatform.ScreenPixelHeight();
+}
+
+void CShape::Draw()
+{
+   if (mpRenderPacket)
+      mpRenderPacket->Render();
+}
+
+void CShape::CreateFillPacket(unsigned int type, int vertexCount)
 {
+   unsigned int program = ESShaderRepository::Instance().GetShaderProgram(
+      mbGradient ? ESShaderRepository::GRADIENT_FILL : ESShaderRepository::COLOR_FILL);
+   if (ReusePacket(program, type, vertexCount))
+      return;
+
    mpRenderPacket = new RenderPacket();
    // Init the render packet which will be passed to the scene graph on render.
    mpRenderPacket->mMasterZ = 0.0f;
@@ -22,12 +270,14 @@ CLine::CLine(float tx0, float ty0, float tx1, float ty1, float tfWidth) : IPrimi
    // Create VBO for drawing the image
    glGenBuffers(1, &mpRenderPacket->miVbo);
    // Set the shader program
-   mpRenderPacket->miShaderProgram =
-      ESShaderRepository::Instance().GetShaderProgram(ESShaderRepository::COLOR_FILL);
+   mpRenderPacket->miShaderProgram = program;
    // Set to no rotation etc...
    mpRenderPacket->mTransform.identity();
+   mpRenderPacket->mbPixelSpace = mbPixelSpace;
    // Set type of primatives
-   mpRenderPacket->miType = GL_TRIANGLE_STRIP;
+   mpRenderPacket->miType = type;
+   // Shape color (uColor)
+   mpRenderPacket->mfUniformArray = mfColor;
 
    // shader (COLOR_FILL)
    mpRenderPacket->miVertArraySize = 3;
@@ -39,14 +289,167 @@ CLine::CLine(float tx0, float ty0, float tx1, float ty1, float tfWidth) : IPrimi
    mpRenderPacket->miVertexStride =
       7 * sizeof(GLfloat);  // 3 floats for the pos, 4 for color
 
-   mpRenderPacket->miVertexCount = 4;
+   mpRenderPacket->miVertexCount = vertexCount;
    // copy verts to local buffer
    mpRenderPacket->mfVertices =
       new float[mpRenderPacket->miVertexStride * mpRenderPacket->miVertexCount];
+   ApplyGradient();
+}
+
+bool CShape::CreateMeshPacket(const ShapeMesh& mesh)
+{
+   if (mesh.VertexCount() > ShapeMesh::MAX_VERTICES)
+   {
+      addlog(Log::L_ERROR, "Shape of %zu vertices is too large for 16 bit indices",
+             mesh.VertexCount());
+      ReleasePacket();
+      return false;
+   }
+   CreateFillPacket(GL_TRIANGLES, static_cast<int>(mesh.VertexCount()));
+   std::copy(mesh.mVertices.begin(), mesh.mVertices.end(), mpRenderPacket->mfVertices);
+
+   if (mpRenderPacket->miIbo && (mIndices == mesh.mIndices))
+      return true;
+
+   mIndices = mesh.mIndices;
+   if (!mpRenderPacket->miIbo)
+      glGenBuffers(1, &mpRenderPacket->miIbo);
+   mpRenderPacket->mbIndicesDirty = true;
+   mpRenderPacket->miIndexType = GL_UNSIGNED_SHORT;
+   mpRenderPacket->miIndexCount = mIndices.size();
+   mpRenderPacket->mpIndices = mIndices.data();
+   return true;
+}
+
+void CShape::CreateSdfPacket(float cx, float cy, float ux, float uy, float hx, float hy)
+{
+   // Leave room for the antialiased edge (2 pixels)
+   float px, py;
+   PixelSize(px, py);
+   float margin = 2.0f * std::max(px, py);
+   hx += margin;
+   hy += margin;
+
+   unsigned int program =
+      ESShaderRepository::Instance().GetShaderProgram(ESShaderRepository::SHAPE_SDF);
+   if (!ReusePacket(program, GL_TRIANGLE_STRIP, 4))
+   {
+      mpRenderPacket = new RenderPacket();
+      // Init the render packet which will be passed to the scene graph on render.
+      mpRenderPacket->mMasterZ = 0.0f;
+
+      // No texture, the texture coordinates carry the shape local position
+      mpRenderPacket->miTexture = 0;
+      // Create VBO for drawing the image
+      glGenBuffers(1, &mpRenderPacket->miVbo);
+      // Set the shader program
+      mpRenderPacket->miShaderProgram = program;
+      // Set to no rotation etc...
+      mpRenderPacket->mTransform.identity();
+      mpRenderPacket->mbPixelSpace = mbPixelSpace;
+      // Set type of primatives
+      mpRenderPacket->miType = GL_TRIANGLE_STRIP;
+
+      // shader (SHAPE_SDF)
+      mpRenderPacket->miVertArraySize = 3;
+      mpRenderPacket->miVertArrayOffset = 0;
+      mpRenderPacket->miTextureArraySize = 2;
+      mpRenderPacket->miTextureArrayOffset = 3;
+      mpRenderPacket->miColorArraySize = 4;
+      mpRenderPacket->miColorArrayOffset = 5;
+      mpRenderPacket->miVertexStride =
+         9 * sizeof(GLfloat);  // 3 floats for the pos, 2 for the local pos, 4 for color
+
+      mpRenderPacket->miVertexCount = 4;
+      mpRenderPacket->mfVertices = new float[9 * 4];
+
+      mpRenderPacket->mfParamArray = mfSdfParams;
+      mpRenderPacket->miParamCount = 2;
+      mpRenderPacket->mfUniformArray = mfColor;
+   }
+
+   // UL, UR, LL, LR in local coordinates
+   static const float corners[4][2] = {{-1, 1}, {1, 1}, {-1, -1}, {1, -1}};
+   int vi = 0;
+   for (int i = 0; i < 4; i++)
+   {
+      float lx = corners[i][0] * hx;
+      float ly = corners[i][1] * hy;
+      mpRenderPacket->mfVertices[vi++] = cx + (ux * lx) - (uy * ly);
+      mpRenderPacket->mfVertices[vi++] = cy + (uy * lx) + (ux * ly);
+      mpRenderPacket->mfVertices[vi++] = 0;
+      mpRenderPacket->mfVertices[vi++] = lx;  // local x
+      mpRenderPacket->mfVertices[vi++] = ly;  // local y
+      mpRenderPacket->mfVertices[vi++] = 1;  // R
+      mpRenderPacket->mfVertices[vi++] = 1;  // G
+      mpRenderPacket->mfVertices[vi++] = 1;  // B
+      mpRenderPacket->mfVertices[vi++] = 1;  // A
+   }
+}
+
+/*******************************************/
+CLine::CLine(float tx0, float ty0, float tx1, float ty1, float tfWidth, const Style& style) : CShape(style, true),
+   x0(tx0), y0(ty0), x1(tx1), y1(ty1)
+{
+   mStyle.strokeWidth = tfWidth;
 }
 
 void CLine::Instantiate()
 {
+   float x0 = this->x0;
+   float y0 = this->y0;
+   float x1 = this->x1;
+   float y1 = this->y1;
+   if (mbPixelSpace)
+   {
+      // horizontal and vertical lines get crisp edges, the ends land on whole pixels
+      if (x0 == x1)
+         x0 = x1 = SnapCenter(x0, mStyle.strokeWidth);
+      else
+      {
+         x0 = floorf(x0 + 0.5f);
+         x1 = floorf(x1 + 0.5f);
+      }
+      if (y0 == y1)
+         y0 = y1 = SnapCenter(y0, mStyle.strokeWidth);
+      else
+      {
+         y0 = floorf(y0 + 0.5f);
+         y1 = floorf(y1 + 0.5f);
+      }
+   }
+
+   if (mbSdf)
+   {
+      // capsule along the line
+      float dx = x1 - x0;
+      float dy = y1 - y0;
+      float len = sqrt((dx * dx) + (dy * dy));
+      float ux = (len > 0) ? dx / len : 1.0f;
+      float uy = (len > 0) ? dy / len : 0.0f;
+      float r = mStyle.strokeWidth / 2;
+
+      mfSdfParams[0] = SDF_BOX;
+      mfSdfParams[1] = (len / 2) + r;
+      mfSdfParams[2] = r;
+      mfSdfParams[3] = r;
+      CreateSdfPacket((x0 + x1) / 2, (y0 + y1) / 2, ux, uy, (len / 2) + r, r);
+      return;
+   }
+
+   if (mbAntialias)
+   {
+      float px, py;
+      PixelSize(px, py);
+      ShapeMesh mesh(true, px, py);
+      Vector2 pts[2] = {Vector2(x0, y0), Vector2(x1, y1)};
+      mesh.AddStroke(pts, 2, false, mStyle.strokeWidth / 2, WHITE);
+      CreateMeshPacket(mesh);
+      return;
+   }
+
+   CreateFillPacket(GL_TRIANGLE_STRIP, 4);
+
    //Generate box corners
    Vector2 a, b, c, d;
    Vector2 p, q;
@@ -54,10 +457,10 @@ void CLine::Instantiate()
    p.y = y0;
    q.x = x1;
    q.y = y1;
-   float l = fWidth;
+   float l = mStyle.strokeWidth;
 
 
-   // horizontal rectangle 
+   // horizontal rectangle
    if (p.x == q.x)
    {
       a.x = p.x - (l / 2.0);
@@ -73,7 +476,7 @@ void CLine::Instantiate()
       c.y = q.y;
    }
 
-   // vertical rectangle 
+   // vertical rectangle
    else if (p.y == q.y)
    {
       a.y = p.y - (l / 2.0);
@@ -89,13 +492,13 @@ void CLine::Instantiate()
       c.x = q.x;
    }
 
-   // slanted rectangle 
+   // slanted rectangle
    else
    {
-      // calculate slope of the side 
+      // calculate slope of the side
       double m = (p.x - q.x) / float(q.y - p.y);
 
-      // calculate displacements along axes 
+      // calculate displacements along axes
       float dx = (l);
       dx /= sqrt(1.0 + (m * m));
       dx *= 0.5;
@@ -116,41 +519,11 @@ void CLine::Instantiate()
    }
 
    // load verts with data
-   float dz = 0.0f;
    int vi = 0;
-   int ci = 0;
-
-   mpRenderPacket->mfVertices[vi++] = a.x;  // UL
-   mpRenderPacket->mfVertices[vi++] = a.y;
-   mpRenderPacket->mfVertices[vi++] = dz;
-   mpRenderPacket->mfVertices[vi++] = 1;    // R
-   mpRenderPacket->mfVertices[vi++] = 0;  // G
-   mpRenderPacket->mfVertices[vi++] = 0;   // B
-   mpRenderPacket->mfVertices[vi++] = 1;  // A
-
-   mpRenderPacket->mfVertices[vi++] = b.x;  // UR
-   mpRenderPacket->mfVertices[vi++] = b.y;
-   mpRenderPacket->mfVertices[vi++] = dz;
-   mpRenderPacket->mfVertices[vi++] = 1;    // R
-   mpRenderPacket->mfVertices[vi++] = 0;  // G
-   mpRenderPacket->mfVertices[vi++] = 0;   // B
-   mpRenderPacket->mfVertices[vi++] = 1;  // A
-
-   mpRenderPacket->mfVertices[vi++] = d.x;  // LL
-   mpRenderPacket->mfVertices[vi++] = d.y;
-   mpRenderPacket->mfVertices[vi++] = dz;
-   mpRenderPacket->mfVertices[vi++] = 1;    // R
-   mpRenderPacket->mfVertices[vi++] = 0;  // G
-   mpRenderPacket->mfVertices[vi++] = 0;   // B
-   mpRenderPacket->mfVertices[vi++] = 1;  // A
-
-   mpRenderPacket->mfVertices[vi++] = c.x;  // LR
-   mpRenderPacket->mfVertices[vi++] = c.y;
-   mpRenderPacket->mfVertices[vi++] = dz;
-   mpRenderPacket->mfVertices[vi++] = 1;    // R
-   mpRenderPacket->mfVertices[vi++] = 0;  // G
-   mpRenderPacket->mfVertices[vi++] = 0;   // B
-   mpRenderPacket->mfVertices[vi++] = 1;  // A
+   PutVertex(mpRenderPacket->mfVertices, vi, a.x, a.y, WHITE);  // UL
+   PutVertex(mpRenderPacket->mfVertices, vi, b.x, b.y, WHITE);  // UR
+   PutVertex(mpRenderPacket->mfVertices, vi, d.x, d.y, WHITE);  // LL
+   PutVertex(mpRenderPacket->mfVertices, vi, c.x, c.y, WHITE);  // LR
 
    mpRenderPacket->mTransform[12] = 0;
    mpRenderPacket->mTransform[13] = 0;
@@ -158,403 +531,831 @@ void CLine::Instantiate()
 
 CLine::~CLine()
 {
-   delete mpRenderPacket;
 }
 
-
-void CLine::Draw()
+void CLine::SetEndpoints(float tx0, float ty0, float tx1, float ty1)
 {
-   mpRenderPacket->Render();
-
+   x0 = tx0;
+   y0 = ty0;
+   x1 = tx1;
+   y1 = ty1;
+   if (mpRenderPacket)
+      Instantiate();
 }
+
 /*******************************************/
-CCircle::CCircle(float tx0, float ty0, float tradius, int tsides) : IPrimitive(),
+CCircle::CCircle(float tx0, float ty0, float tradius, int tsides, const Style& style) : CShape(style, false),
    x0(tx0), y0(ty0), radius(tradius), sides(tsides)
 {
-   mpRenderPacket = NULL;
-
 }
 
-CCircle::CCircle()
+CCircle::CCircle() : CCircle(0.5f, 0.5f, 0.2f, 25)
 {
-   CCircle(0.5f,0.5f, 0.2f, 25);
 }
+
 void CCircle::Instantiate()
 {
-   GLint numberOfVertices = sides + 2;
-
-   mpRenderPacket = new RenderPacket();
-   // Init the render packet which will be passed to the scene graph on render.
-   mpRenderPacket->mMasterZ = 0.0f;
-
-   // Set the texture id
-   mpRenderPacket->miTexture = 0;
-   // Create VBO for drawing the image
-   glGenBuffers(1, &mpRenderPacket->miVbo);
-   // Set the shader program
-   mpRenderPacket->miShaderProgram =
-      ESShaderRepository::Instance().GetShaderProgram(ESShaderRepository::COLOR_FILL);
-   // Set to no rotation etc...
-   mpRenderPacket->mTransform.identity();
-   // Set type of primatives
-   mpRenderPacket->miType = GL_TRIANGLE_FAN;
+   if (mbSdf)
+   {
+      mfSdfParams[0] = SDF_CIRCLE;
+      mfSdfParams[3] = radius;
+      CreateSdfPacket(0, 0, 1, 0, radius, radius);
+      SetTranslation(x0, y0);
+      return;
+   }
 
-   // shader (COLOR_FILL)
-   mpRenderPacket->miVertArraySize = 3;
-   mpRenderPacket->miVertArrayOffset = 0;
-   mpRenderPacket->miTextureArraySize = 0;
-   mpRenderPacket->miTextureArrayOffset = 0;
-   mpRenderPacket->miColorArraySize = 4;
-   mpRenderPacket->miColorArrayOffset = 3;
-   mpRenderPacket->miVertexStride =
-      7 * sizeof(GLfloat);  // 3 floats for the pos, 4 for color
+   if (mbAntialias)
+   {
+      float px, py;
+      PixelSize(px, py);
+      ShapeMesh mesh(true, px, py);
+      std::vector<Vector2> pts(sides);
+      for (int i = 0; i < sides; i++)
+      {
+         float theta = (TWOPI * i) / sides;
+         pts[i].set(radius * cos(theta), radius * sin(theta));
+      }
+      uint16_t center = mesh.AddVertex(0, 0, WHITE);
+      uint16_t first = mesh.AddLoop(pts.data(), sides, WHITE);
+      mesh.AddFan(center, first, sides, true);
+      CreateMeshPacket(mesh);
+      SetTranslation(x0, y0);
+      return;
+   }
 
-   mpRenderPacket->miVertexCount = numberOfVertices; // nVerts;
-                                                     // copy verts to local buffer
-   mpRenderPacket->mfVertices =
-      new float[mpRenderPacket->miVertexStride * mpRenderPacket->miVertexCount];
+   GLint numberOfVertices = sides + 2;
+   CreateFillPacket(GL_TRIANGLE_FAN, numberOfVertices);
 
-   mpRenderPacket->mfVertices[0] = x0;
-   mpRenderPacket->mfVertices[1] = y0;
-   mpRenderPacket->mfVertices[2] = 0.0;
-   mpRenderPacket->mfVertices[3] = 0;
-   mpRenderPacket->mfVertices[4] = 0;
-   mpRenderPacket->mfVertices[5] = 1;
-   mpRenderPacket->mfVertices[6] = 0.4;
+   int vi = 0;
+   PutVertex(mpRenderPacket->mfVertices, vi, 0, 0, WHITE);
 
    float fStep = TWOPI / sides;
    float theta = 0;
 
    for (int i = 1; i < numberOfVertices; i++)
    {
-      mpRenderPacket->mfVertices[i * 7] = x0 + (radius * cos(theta));
-      mpRenderPacket->mfVertices[(i * 7) + 1] = y0 + (radius * sin(theta));
-      mpRenderPacket->mfVertices[(i * 7) + 2] = 0;
-      mpRenderPacket->mfVertices[(i * 7) + 3] = 0;
-      mpRenderPacket->mfVertices[(i * 7) + 4] = 0;
-      mpRenderPacket->mfVertices[(i * 7) + 5] = 1;
-      mpRenderPacket->mfVertices[(i * 7) + 6] = 0.4;
+      PutVertex(mpRenderPacket->mfVertices, vi, radius * cos(theta),
+                radius * sin(theta), WHITE);
       theta += fStep;
    }
+
+   SetTranslation(x0, y0);
 }
 
 
 CCircle::~CCircle()
 {
-   if (mpRenderPacket)
-      delete mpRenderPacket;
 }
 
-
-void CCircle::Draw()
+void CCircle::SetCenter(float x, float y)
 {
+   // the vertices are around the origin, only the transform moves
+   x0 = x;
+   y0 = y;
    if (mpRenderPacket)
-      mpRenderPacket->Render();
+      SetTranslation(x0, y0);
+}
 
+void CCircle::SetRadius(float r)
+{
+   radius = r;
+   if (mpRenderPacket)
+      Instantiate();
 }
 
 /*******************************************/
-CCircleLine::CCircleLine()
+CCircleLine::CCircleLine() : CCircleLine(-0.6f, -0.5f, 0.2f, 35)
 {
-   CCircleLine(-0.6f, -0.5f, 0.2f, 35);
 }
-CCircleLine::CCircleLine(float x0, float y0, float radius, int sides) : IPrimitive(),
+
+CCircleLine::CCircleLine(float x0, float y0, float radius, int sides, const Style& style) : CShape(style, true),
    mx0(x0), my0(y0), mradius(radius), msides(sides)
 {
-   mpRenderPacket = nullptr;
 }
 
 void CCircleLine::Instantiate()
 {
-   GLint numberOfVertices = msides + 1;
-
-   mpRenderPacket = new RenderPacket();
-   // Init the render packet which will be passed to the scene graph on render.
-   mpRenderPacket->mMasterZ = 0.0f;
-
-   // Set the texture id
-   mpRenderPacket->miTexture = 0;
-   // Create VBO for drawing the image
-   glGenBuffers(1, &mpRenderPacket->miVbo);
-   // Set the shader program
-   mpRenderPacket->miShaderProgram =
-      ESShaderRepository::Instance().GetShaderProgram(ESShaderRepository::COLOR_FILL);
-   // Set to no rotation etc...
-   mpRenderPacket->mTransform.identity();
-   // Set type of primatives
-   mpRenderPacket->miType = GL_LINE_LOOP;
+   if (mbSdf)
+   {
+      // ring centered on the radius (one pixel without a stroke width)
+      float w = mStyle.strokeWidth;
+      mfSdfParams[0] = SDF_CIRCLE;
+      mfSdfParams[3] = mradius + (w / 2);
+      mfSdfParams[4] = 1;
+      mfSdfParams[5] = w;
+      CreateSdfPacket(0, 0, 1, 0, mradius + (w / 2), mradius + (w / 2));
+      SetTranslation(mx0, my0);
+      return;
+   }
 
-   // shader (COLOR_FILL)
-   mpRenderPacket->miVertArraySize = 3;
-   mpRenderPacket->miVertArrayOffset = 0;
-   mpRenderPacket->miTextureArraySize = 0;
-   mpRenderPacket->miTextureArrayOffset = 0;
-   mpRenderPacket->miColorArraySize = 4;
-   mpRenderPacket->miColorArrayOffset = 3;
-   mpRenderPacket->miVertexStride =
-      7 * sizeof(GLfloat);  // 3 floats for the pos, 4 for color
+   if (mbAntialias || (mStyle.strokeWidth > 0))
+   {
+      float px, py;
+      PixelSize(px, py);
+      ShapeMesh mesh(mbAntialias, px, py);
+      int sides = static_cast<int>(msides);
+      std::vector<Vector2> pts(sides);
+      for (int i = 0; i < sides; i++)
+      {
+         float theta = (TWOPI * i) / sides;
+         pts[i].set(mradius * cos(theta), mradius * sin(theta));
+      }
+      mesh.AddStroke(pts.data(), sides, true, mStyle.strokeWidth / 2, WHITE);
+      CreateMeshPacket(mesh);
+      SetTranslation(mx0, my0);
+      return;
+   }
 
-   mpRenderPacket->miVertexCount = numberOfVertices; // nVerts;
-                                                     // copy verts to local buffer
-   mpRenderPacket->mfVertices =
-      new float[mpRenderPacket->miVertexStride * mpRenderPacket->miVertexCount];
+   GLint numberOfVertices = msides + 1;
+   CreateFillPacket(GL_LINE_LOOP, numberOfVertices);
 
    float fStep = TWOPI / msides;
    float theta = 0;
 
+   int vi = 0;
    for (int i = 0; i < numberOfVertices; i++)
    {
-      mpRenderPacket->mfVertices[i * 7] = mx0 + (mradius * cos(theta));
-      mpRenderPacket->mfVertices[(i * 7) + 1] = my0 + (mradius * sin(theta));
-      mpRenderPacket->mfVertices[(i * 7) + 2] = 0;
-      mpRenderPacket->mfVertices[(i * 7) + 3] = 0;
-      mpRenderPacket->mfVertices[(i * 7) + 4] = 1;
-      mpRenderPacket->mfVertices[(i * 7) + 5] = 1;
-      mpRenderPacket->mfVertices[(i * 7) + 6] = 1;
+      PutVertex(mpRenderPacket->mfVertices, vi, mradius * cos(theta),
+                mradius * sin(theta), WHITE);
       theta += fStep;
    }
+
+   SetTranslation(mx0, my0);
 }
 
 
 CCircleLine::~CCircleLine()
 {
-   if (mpRenderPacket)
-      delete mpRenderPacket;
 }
 
-
-void CCircleLine::Draw()
+void CCircleLine::SetCenter(float x, float y)
 {
+   // the vertices are around the origin, only the transform moves
+   mx0 = x;
+   my0 = y;
    if (mpRenderPacket)
-      mpRenderPacket->Render();
-
+      SetTranslation(mx0, my0);
 }
 
-/*******************************************/
+void CCircleLine::SetRadius(float r)
+{
+   mradius = r;
+   if (mpRenderPacket)
+      Instantiate();
+}
 
 /*******************************************/
-CFanLine::CFanLine()
+CFanLine::CFanLine() : CFanLine(-0.6f, 0.5f, 0.2f, 15, 0, 180)
 {
-   CFanLine(-0.6f, 0.5f, 0.2f, 15, 0, 180);
 }
 
-CFanLine::CFanLine(float x0, float y0, float radius, int sides, float start, float stop) : IPrimitive(),
+CFanLine::CFanLine(float x0, float y0, float radius, int sides, float start, float stop, const Style& style) : CShape(style, true),
    mx0(x0), my0(y0), mradius(radius), msides(sides), mstart(start), mstop(stop)
 {
-   mpRenderPacket = NULL;
 }
 
 void CFanLine::Instantiate()
 {
-   mstart *= DEG2RAD;
-   mstop *= DEG2RAD;
-
-   GLint numberOfVertices = msides + 1;
+   float start = mstart * DEG2RAD;
+   float stop = mstop * DEG2RAD;
+   float fStep = (start - stop) / msides;
 
-   mpRenderPacket = new RenderPacket();
-   // Init the render packet which will be passed to the scene graph on render.
-   mpRenderPacket->mMasterZ = 0.0f;
-
-   // Set the texture id
-   mpRenderPacket->miTexture = 0;
-   // Create VBO for drawing the image
-   glGenBuffers(1, &mpRenderPacket->miVbo);
-   // Set the shader program
-   mpRenderPacket->miShaderProgram =
-      ESShaderRepository::Instance().GetShaderProgram(ESShaderRepository::COLOR_FILL);
-   // Set to no rotation etc...
-   mpRenderPacket->mTransform.identity();
-   // Set type of primatives
-   mpRenderPacket->miType = GL_LINE_STRIP;
+   if (mbSdf)
+   {
+      // arc over the same sweep as the tessellated line (one pixel without a stroke width)
+      float sweep = fStep * msides;
+      float w = mStyle.strokeWidth;
+      mfSdfParams[0] = SDF_ARC;
+      mfSdfParams[3] = mradius + (w / 2);
+      mfSdfParams[4] = 1;
+      mfSdfParams[5] = w;
+      mfSdfParams[6] = start + (sweep / 2);
+      mfSdfParams[7] = fabs(sweep / 2);
+      CreateSdfPacket(0, 0, 1, 0, mradius + (w / 2), mradius + (w / 2));
+      SetTranslation(mx0, my0);
+      return;
+   }
 
-   // shader (COLOR_FILL)
-   mpRenderPacket->miVertArraySize = 3;
-   mpRenderPacket->miVertArrayOffset = 0;
-   mpRenderPacket->miTextureArraySize = 0;
-   mpRenderPacket->miTextureArrayOffset = 0;
-   mpRenderPacket->miColorArraySize = 4;
-   mpRenderPacket->miColorArrayOffset = 3;
-   mpRenderPacket->miVertexStride =
-      7 * sizeof(GLfloat);  // 3 floats for the pos, 4 for color
+   GLint numberOfVertices = msides + 1;
+   if (mbAntialias || (mStyle.strokeWidth > 0))
+   {
+      float px, py;
+      PixelSize(px, py);
+      ShapeMesh mesh(mbAntialias, px, py);
+      std::vector<Vector2> pts(numberOfVertices);
+      for (int i = 0; i < numberOfVertices; i++)
+      {
+         float theta = start + (fStep * i);
+         pts[i].set(mradius * cos(theta), mradius * sin(theta));
+      }
+      mesh.AddStroke(pts.data(), numberOfVertices, false, mStyle.strokeWidth / 2, WHITE);
+      CreateMeshPacket(mesh);
+      SetTranslation(mx0, my0);
+      return;
+   }
 
-   mpRenderPacket->miVertexCount = numberOfVertices; // nVerts;
-                                                     // copy verts to local buffer
-   mpRenderPacket->mfVertices =
-      new float[mpRenderPacket->miVertexStride * mpRenderPacket->miVertexCount];
+   CreateFillPacket(GL_LINE_STRIP, numberOfVertices);
 
-   float fStep = (mstart - mstop) / msides;
-   float theta = mstart;
+   float theta = start;
 
+   int vi = 0;
    for (int i = 0; i < numberOfVertices; i++)
    {
-      mpRenderPacket->mfVertices[i * 7] = mx0 + (mradius * cos(theta));
-      mpRenderPacket->mfVertices[(i * 7) + 1] = my0 + (mradius * sin(theta));
-      mpRenderPacket->mfVertices[(i * 7) + 2] = 0;
-      mpRenderPacket->mfVertices[(i * 7) + 3] = 0;
-      mpRenderPacket->mfVertices[(i * 7) + 4] = 1;
-      mpRenderPacket->mfVertices[(i * 7) + 5] = 1;
-      mpRenderPacket->mfVertices[(i * 7) + 6] = 1;
+      PutVertex(mpRenderPacket->mfVertices, vi, mradius * cos(theta),
+                mradius * sin(theta), WHITE);
       theta += fStep;
    }
+
+   SetTranslation(mx0, my0);
 }
 
 /**************************/
 CFanLine::~CFanLine()
 {
-   if (mpRenderPacket)
-      delete mpRenderPacket;
 }
 
-
-void CFanLine::Draw()
+void CFanLine::SetCenter(float x, float y)
 {
+   // the vertices are around the origin, only the transform moves
+   mx0 = x;
+   my0 = y;
    if (mpRenderPacket)
-      mpRenderPacket->Render();
+      SetTranslation(mx0, my0);
+}
 
+void CFanLine::SetRadius(float r)
+{
+   mradius = r;
+   if (mpRenderPacket)
+      Instantiate();
 }
 
 /*****************/
-CFan::CFan()
+CFan::CFan() : CFan(-0.4, 0.1f, 200.0 / 1024.0, 10, 90, 180)
 {
-   CFan(-0.4, 0.1f, 200.0 / 1024.0, 10, 90, 180);
 }
 
-CFan::CFan(float x0, float y0, float radius, int sides, float start, float stop)  : IPrimitive(),
+CFan::CFan(float x0, float y0, float radius, int sides, float start, float stop, const Style& style) : CShape(style, false),
    mx0(x0), my0(y0), mradius(radius), msides(sides), mstart(start), mstop(stop)
 {
-   mpRenderPacket = NULL;
 }
 
 void CFan::Instantiate()
 {
-   mstart *= DEG2RAD;
-   mstop *= DEG2RAD;
-
-   GLint numberOfVertices = msides + 2;
-
-   mpRenderPacket = new RenderPacket();
-   // Init the render packet which will be passed to the scene graph on render.
-   mpRenderPacket->mMasterZ = 0.0f;
+   float start = mstart * DEG2RAD;
+   float stop = mstop * DEG2RAD;
 
-   // Set the texture id
-   mpRenderPacket->miTexture = 0;
-   // Create VBO for drawing the image
-   glGenBuffers(1, &mpRenderPacket->miVbo);
-   // Set the shader program
-   mpRenderPacket->miShaderProgram =
-      ESShaderRepository::Instance().GetShaderProgram(ESShaderRepository::COLOR_FILL);
-   // Set to no rotation etc...
-   mpRenderPacket->mTransform.identity();
-   // Set type of primatives
-   mpRenderPacket->miType = GL_TRIANGLE_FAN;
+   float fStep = (stop - start) / msides;
 
-   // shader (COLOR_FILL)
-   mpRenderPacket->miVertArraySize = 3;
-   mpRenderPacket->miVertArrayOffset = 0;
-   mpRenderPacket->miTextureArraySize = 0;
-   mpRenderPacket->miTextureArrayOffset = 0;
-   mpRenderPacket->miColorArraySize = 4;
-   mpRenderPacket->miColorArrayOffset = 3;
-   mpRenderPacket->miVertexStride =
-      7 * sizeof(GLfloat);  // 3 floats for the pos, 4 for color
+   GLint numberOfVertices = msides + 2;
+   if (mbAntialias)
+   {
+      // the outline runs from the center around the arc and back
+      float px, py;
+      PixelSize(px, py);
+      ShapeMesh mesh(true, px, py);
+      std::vector<Vector2> pts(numberOfVertices);
+      pts[0].set(0, 0);
+      for (int i = 1; i < numberOfVertices; i++)
+      {
+         float theta = start + (fStep * (i - 1));
+         pts[i].set(mradius * cos(theta), mradius * sin(theta));
+      }
+      uint16_t first = mesh.AddLoop(pts.data(), numberOfVertices, WHITE);
+      mesh.AddFan(first, first + 1, numberOfVertices - 1, false);
+      CreateMeshPacket(mesh);
+      SetTranslation(mx0, my0);
+      return;
+   }
 
-   mpRenderPacket->miVertexCount = numberOfVertices; // nVerts;
-                                                     // copy verts to local buffer
-   mpRenderPacket->mfVertices =
-      new float[mpRenderPacket->miVertexStride * mpRenderPacket->miVertexCount];
+   CreateFillPacket(GL_TRIANGLE_FAN, numberOfVertices);
 
-   mpRenderPacket->mfVertices[0] = mx0;
-   mpRenderPacket->mfVertices[1] = my0;
-   mpRenderPacket->mfVertices[2] = 0.0;
-   mpRenderPacket->mfVertices[3] = 1;
-   mpRenderPacket->mfVertices[4] = 0;
-   mpRenderPacket->mfVertices[5] = 1;
-   mpRenderPacket->mfVertices[6] = 0.4;
+   int vi = 0;
+   PutVertex(mpRenderPacket->mfVertices, vi, 0, 0, WHITE);
 
-   float fStep = (mstop - mstart) / msides;
-   float theta = mstart;
+   float theta = start;
    for (int i = 1; i < numberOfVertices; i++)
    {
-      mpRenderPacket->mfVertices[i * 7] = mx0 + (mradius * cos(theta));
-      mpRenderPacket->mfVertices[(i * 7) + 1] = my0 + (mradius * sin(theta));
-      mpRenderPacket->mfVertices[(i * 7) + 2] = 0;
-      mpRenderPacket->mfVertices[(i * 7) + 3] = 1;
-      mpRenderPacket->mfVertices[(i * 7) + 4] = 0;
-      mpRenderPacket->mfVertices[(i * 7) + 5] = 1;
-      mpRenderPacket->mfVertices[(i * 7) + 6] = 0.4;
+      PutVertex(mpRenderPacket->mfVertices, vi, mradius * cos(theta),
+                mradius * sin(theta), WHITE);
       theta += fStep;
    }
+
+   SetTranslation(mx0, my0);
 }
 
 CFan::~CFan()
 {
-   if (mpRenderPacket)
-      delete mpRenderPacket;
 }
 
-
-void CFan::Draw()
+void CFan::SetCenter(float x, float y)
 {
+   // the vertices are around the origin, only the transform moves
+   mx0 = x;
+   my0 = y;
    if (mpRenderPacket)
-      mpRenderPacket->Render();
+      SetTranslation(mx0, my0);
+}
 
+void CFan::SetRadius(float r)
+{
+   mradius = r;
+   if (mpRenderPacket)
+      Instantiate();
 }
 
 /****************************************/
-CRoundRectangle::CRoundRectangle()
+// Segments used to tessellate each rounded corner
+constexpr int CORNER_SIDES = 10;
+
+CRoundRectangle::CRoundRectangle() : CRoundRectangle(-0.9, 0.9, 0.9, -0.9, 40.0 / 1024.0)
 {
-   CRoundRectangle(-0.9, 0.9, 0.9, -0.9, 40.0 / 1024.0);
 }
 
-CRoundRectangle::CRoundRectangle(float x0, float y0, float x1, float y1, float width) :IPrimitive(),
-   mx0(x0), my0(y0), mx1(x1), my1(y1), mwidth(width)
+CRoundRectangle::CRoundRectangle(float x0, float y0, float x1, float y1, float width, bool bFilled, const Style& style) : CShape(style, !bFilled),
+   mx0(x0), my0(y0), mx1(x1), my1(y1), mbFilled(bFilled)
 {
-   for (int i = 0; i < 4; i++)
-   {
-      pLines[i] = NULL;
-      pFans[i]  = NULL;
-   }
+   // the panel is sized and rounded by the width too
+   mStyle.strokeWidth = width;
+   mbUsesWidth = true;
 }
 
 void CRoundRectangle::Instantiate()
 {
-   pLines[0] = new CLine(mx0 + mwidth / 2, my0, mx1 - mwidth / 2, my0, mwidth);
-   pLines[0]->Instantiate();
-   pLines[1] = new CLine(mx1, my0 - mwidth / 2, mx1, my1 + mwidth / 2, mwidth);
-   pLines[1]->Instantiate();
-   pLines[2] = new CLine(mx1 - mwidth / 2, my1, mx0 + mwidth / 2, my1, mwidth);
-   pLines[2]->Instantiate();
-   pLines[3] = new CLine(mx0, my1 + mwidth / 2, mx0, my0 - mwidth / 2, mwidth);
-   pLines[3]->Instantiate();
+   if (mbSdf)
+   {
+      // the outer edge is rounded by the width, the frame is drawn inside it
+      float hw = fabs(mx1 - mx0) / 2 + (mStyle.strokeWidth / 2);
+      float hh = fabs(my0 - my1) / 2 + (mStyle.strokeWidth / 2);
+      mfSdfParams[0] = SDF_BOX;
+      mfSdfParams[1] = hw;
+      mfSdfParams[2] = hh;
+      mfSdfParams[3] = mStyle.strokeWidth;
+      mfSdfParams[4] = mbFilled ? 0 : 1;
+      mfSdfParams[5] = mStyle.strokeWidth;
+      CreateSdfPacket((mx0 + mx1) / 2, (my0 + my1) / 2, 1, 0, hw, hh);
+      return;
+   }
+
+   // One quarter circle, shared by all four corners (rotated by 90 degrees each)
+   float fCos[CORNER_SIDES + 1];
+   float fSin[CORNER_SIDES + 1];
+   float fStep = (PI / 2) / CORNER_SIDES;
+   for (int i = 0; i <= CORNER_SIDES; i++)
+   {
+      fCos[i] = cos(i * fStep);
+      fSin[i] = sin(i * fStep);
+   }
 
+   // Corner arc centers, counter clockwise starting at the upper right (0 to 90 degrees).
+   // The outer edge is rounded by the width around them, the inner edge is square at them.
+   float hw = mStyle.strokeWidth / 2;
+   float cx[4] = { mx1 - hw, mx0 + hw, mx0 + hw, mx1 - hw };
+   float cy[4] = { my0 - hw, my0 - hw, my1 + hw, my1 + hw };
 
-   pFans[0] = new CFan(mx0 + mwidth / 2, my0 - mwidth / 2, mwidth, 10, 90, 180);
-   pFans[0]->Instantiate();
-   pFans[1] = new CFan(mx1 - mwidth / 2, my0 - mwidth / 2, mwidth, 10, 0, 90);
-   pFans[1]->Instantiate();
-   pFans[2] = new CFan(mx0 + mwidth / 2, my1 + mwidth / 2, mwidth, 10, 270, 180);
-   pFans[2]->Instantiate();
-   pFans[3] = new CFan(mx1 - mwidth / 2, my1 + mwidth / 2, mwidth, 10, 0, -90);
-   pFans[3]->Instantiate();
+   // outer edge points, CORNER_SIDES + 1 per corner
+   const int perimeter = 4 * (CORNER_SIDES + 1);
+   Vector2 outer[perimeter];
+   for (int corner = 0; corner < 4; corner++)
+   {
+      for (int i = 0; i <= CORNER_SIDES; i++)
+      {
+         // rotate the quarter circle into this corner's quadrant
+         float c = fCos[i];
+         float s = fSin[i];
+         for (int q = 0; q < corner; q++)
+         {
+            float t = c;
+            c = -s;
+            s = t;
+         }
+         outer[(corner * (CORNER_SIDES + 1)) + i].set(cx[corner] + (mStyle.strokeWidth * c),
+                                                       cy[corner] + (mStyle.strokeWidth * s));
+      }
+   }
+
+   if (mbAntialias)
+   {
+      float px, py;
+      PixelSize(px, py);
+      ShapeMesh mesh(true, px, py);
+      uint16_t first = mesh.AddLoop(outer, perimeter, WHITE);
+      if (mbFilled)
+      {
+         uint16_t center = mesh.AddVertex((mx0 + mx1) / 2, (my0 + my1) / 2, WHITE);
+         mesh.AddFan(center, first, perimeter, true);
+      }
+      else
+      {
+         // the inner edge is the hole, join each outer point to its corner
+         Vector2 inner[4];
+         for (int corner = 0; corner < 4; corner++)
+         {
+            inner[corner].set(cx[corner], cy[corner]);
+         }
+         uint16_t hole = mesh.AddLoop(inner, 4, WHITE, true);
+         for (int i = 0; i < perimeter; i++)
+         {
+            int j = (i + 1) % perimeter;
+            int ci = i / (CORNER_SIDES + 1);
+            int cj = j / (CORNER_SIDES + 1);
+            mesh.AddTriangle(first + i, first + j, hole + cj);
+            if (ci != cj)
+            {
+               mesh.AddTriangle(first + i, hole + cj, hole + ci);
+            }
+         }
+      }
+      CreateMeshPacket(mesh);
+      return;
+   }
+
+   // Frame: strip pairs of (outer arc point, inner corner), closed back to the first pair.
+   // Panel: fan from the middle around the outer arc points, closed back to the first point.
+   GLint numberOfVertices = mbFilled ? (perimeter + 2) : ((perimeter * 2) + 2);
+   CreateFillPacket(mbFilled ? GL_TRIANGLE_FAN : GL_TRIANGLE_STRIP, numberOfVertices);
+
+   float* pv = mpRenderPacket->mfVertices;
+   int vi = 0;
+   if (mbFilled)
+   {
+      PutVertex(pv, vi, (mx0 + mx1) / 2, (my0 + my1) / 2, WHITE);
+   }
+
+   for (int i = 0; i < perimeter; i++)
+   {
+      PutVertex(pv, vi, outer[i].x, outer[i].y, WHITE);
+      if (!mbFilled)
+      {
+         int corner = i / (CORNER_SIDES + 1);
+         PutVertex(pv, vi, cx[corner], cy[corner], WHITE);
+      }
+   }
+
+   // close the loop by repeating the first perimeter vertex (or strip pair)
+   int first = mbFilled ? 7 : 0;
+   int count = mbFilled ? 7 : 14;
+   for (int i = 0; i < count; i++)
+   {
+      pv[vi++] = pv[first + i];
+   }
 }
 
 CRoundRectangle::~CRoundRectangle()
 {
-   for (int i = 0; i < 4; i++)
+}
+
+/*******************************************/
+CPolygon::CPolygon(const std::vector<Vector2>& points,
+                   const std::vector<std::vector<Vector2>>& holes, const Style& style)
+   : CShape(style, false), mbTriangulated(false), mx0(0), my0(0)
+{
+   SetPoints(points, holes);
+}
+
+CPolygon::~CPolygon()
+{
+}
+
+void CPolygon::SetPoints(const std::vector<Vector2>& points,
+                         const std::vector<std::vector<Vector2>>& holes)
+{
+   mPoints = points;
+   mLoopSizes.assign(1, static_cast<int>(points.size()));
+   for (const std::vector<Vector2>& hole : holes)
+   {
+      mPoints.insert(mPoints.end(), hole.begin(), hole.end());
+      mLoopSizes.push_back(static_cast<int>(hole.size()));
+   }
+   mbTriangulated = false;
+   if (mpRenderPacket)
+      Instantiate();
+}
+
+void CPolygon::SetPosition(float x, float y)
+{
+   mx0 = x;
+   my0 = y;
+   if (mpRenderPacket)
+      SetTranslation(mx0, my0);
+}
+
+void CPolygon::Instantiate()
+{
+   if (!mbTriangulated)
    {
-      if (pLines[i]) delete pLines[i];
-      if (pFans[i])  delete pFans[i];
+      if (!Triangulator::Triangulate(mPoints, mLoopSizes, mTriangles))
+      {
+         addlog(Log::L_ERROR, "Polygon of %u points is self intersecting",
+                static_cast<unsigned int>(mPoints.size()));
+      }
+      mbTriangulated = true;
    }
 
+   float px, py;
+   PixelSize(px, py);
+   ShapeMesh mesh(mbAntialias, px, py);
+   AddPolygon(mesh, mPoints, mLoopSizes, mTriangles);
+   CreateMeshPacket(mesh);
+   SetTranslation(mx0, my0);
 }
 
+/*******************************************/
+// Upper bound of the segments of one curve
+constexpr int MAX_CURVE_SEGMENTS = 256;
+
+CPath::CPath(bool bFilled, const Style& style)
+   : CShape(style, !bFilled),
+     mbFilled(bFilled),
+     mbFlattened(false),
+     mx0(0),
+     my0(0),
+     mfScale(1.0f),
+     mfTolerance(0.25f)
+{
+}
 
-void CRoundRectangle::Draw()
+CPath::~CPath()
 {
-   for (int i = 0; i < 4; i++)
+}
+
+void CPath::AddCommand(PathOp op, float v0, float v1, float v2, float v3, float v4, float v5,
+                       float v6)
+{
+   PathCommand c = {op, {v0, v1, v2, v3, v4, v5, v6}};
+   mCommands.push_back(c);
+   mbFlattened = false;
+}
+
+void CPath::MoveTo(float x, float y)
+{
+   AddCommand(PATH_MOVE, x, y);
+}
+
+void CPath::LineTo(float x, float y)
+{
+   AddCommand(PATH_LINE, x, y);
+}
+
+void CPath::QuadTo(float cx, float cy, float x, float y)
+{
+   AddCommand(PATH_QUAD, cx, cy, x, y);
+}
+
+void CPath::CubicTo(float cx0, float cy0, float cx1, float cy1, float x, float y)
+{
+   AddCommand(PATH_CUBIC, cx0, cy0, cx1, cy1, x, y);
+}
+
+void CPath::ArcTo(float rx, float ry, float rotation, bool bLargeArc, bool bSweep, float x,
+                  float y)
+{
+   AddCommand(PATH_ARC, rx, ry, rotation, bLargeArc ? 1.0f : 0.0f, bSweep ? 1.0f : 0.0f, x, y);
+}
+
+void CPath::Close()
+{
+   AddCommand(PATH_CLOSE);
+}
+
+void CPath::Clear()
+{
+   mCommands.clear();
+   mbFlattened = false;
+}
+
+void CPath::SetPosition(float x, float y)
+{
+   mx0 = x;
+   my0 = y;
+   if (mpRenderPacket)
+      SetTranslation(mx0, my0);
+}
+
+void CPath::SetScale(float scale)
+{
+   if (scale == mfScale)
+      return;
+   mfScale = scale;
+   mbFlattened = false;
+}
+
+void CPath::SetTolerance(float pixels)
+{
+   mfTolerance = pixels;
+   mbFlattened = false;
+}
+
+void CPath::Flatten()
+{
+   mPoints.clear();
+   mLoopSizes.clear();
+   mClosed.clear();
+
+   // tolerance in path units, a negative scale mirrors the path
+   float px, py;
+   PixelSize(px, py);
+   float tol = (mfTolerance * std::min(px, py)) / fabsf(mfScale);
+
+   Vector2 cur;
+   Vector2 start;
+   int first = 0;
+   auto endSubpath = [&](bool bClosed) {
+      int n = static_cast<int>(mPoints.size()) - first;
+      // a closing point on the start is implied
+      if (bClosed && (n > 1) && mPoints.back().equal(mPoints[first], 1e-6f))
+      {
+         mPoints.pop_back();
+         n--;
+      }
+      if (n > 1)
+      {
+         mLoopSizes.push_back(n);
+         mClosed.push_back(bClosed);
+      }
+      else
+      {
+         mPoints.resize(first);
+      }
+      first = static_cast<int>(mPoints.size());
+   };
+   auto lineTo = [&](const Vector2& p) {
+      if (mPoints.size() == static_cast<size_t>(first))
+         mPoints.push_back(cur);
+      mPoints.push_back(p);
+      cur = p;
+   };
+
+   for (const PathCommand& c : mCommands)
+   {
+      const float* v = c.v;
+      switch (c.op)
+      {
+         case PATH_MOVE:
+            endSubpath(false);
+            cur.set(v[0], v[1]);
+            start = cur;
+            break;
+         case PATH_LINE:
+            lineTo(Vector2(v[0], v[1]));
+            break;
+         case PATH_QUAD:
+         case PATH_CUBIC:
+         {
+            // Wang's formula: segments so the polyline stays within tol of the curve
+            Vector2 p0 = cur;
+            Vector2 p1(v[0], v[1]);
+            Vector2 p2(v[2], v[3]);
+            Vector2 p3(v[4], v[5]);
+            float dd;
+            float k;
+            if (c.op == PATH_QUAD)
+            {
+               dd = (p0 - (p1 * 2.0f) + p2).length();
+               k = 0.25f;
+            }
+            else
+            {
+               dd = std::max((p0 - (p1 * 2.0f) + p2).length(), (p1 - (p2 * 2.0f) + p3).length());
+               k = 0.75f;
+            }
+            int n = static_cast<int>(ceil(sqrt((k * dd) / tol)));
+            n = std::min(std::max(n, 1), MAX_CURVE_SEGMENTS);
+            for (int i = 1; i <= n; i++)
+            {
+               float t = static_cast<float>(i) / n;
+               float u = 1.0f - t;
+               if (c.op == PATH_QUAD)
+                  lineTo((p0 * (u * u)) + (p1 * (2 * u * t)) + (p2 * (t * t)));
+               else
+                  lineTo((p0 * (u * u * u)) + (p1 * (3 * u * u * t)) + (p2 * (3 * u * t * t)) +
+                         (p3 * (t * t * t)));
+            }
+            break;
+         }
+         case PATH_ARC:
+         {
+            // endpoint to center parameterization (SVG implementation notes F.6.5)
+            Vector2 end(v[5], v[6]);
+            float rx = fabs(v[0]);
+            float ry = fabs(v[1]);
+            if ((rx == 0) || (ry == 0) || end.equal(cur, 1e-6f))
+            {
+               lineTo(end);
+               break;
+            }
+            float phi = v[2] * DEG2RAD;
+            float cosPhi = cos(phi);
+            float sinPhi = sin(phi);
+            float dx2 = (cur.x - end.x) / 2;
+            float dy2 = (cur.y - end.y) / 2;
+            float x1p = (cosPhi * dx2) + (sinPhi * dy2);
+            float y1p = (-sinPhi * dx2) + (cosPhi * dy2);
+            float lambda = ((x1p * x1p) / (rx * rx)) + ((y1p * y1p) / (ry * ry));
+            if (lambda > 1)
+            {
+               rx *= sqrt(lambda);
+               ry *= sqrt(lambda);
+            }
+            float num = (rx * rx * ry * ry) - (rx * rx * y1p * y1p) - (ry * ry * x1p * x1p);
+            float den = (rx * rx * y1p * y1p) + (ry * ry * x1p * x1p);
+            float coef = sqrt(std::max(0.0f, num / den));
+            if ((v[3] != 0) == (v[4] != 0))
+               coef = -coef;
+            float cxp = (coef * rx * y1p) / ry;
+            float cyp = (-coef * ry * x1p) / rx;
+            float cx = (cosPhi * cxp) - (sinPhi * cyp) + ((cur.x + end.x) / 2);
+            float cy = (sinPhi * cxp) + (cosPhi * cyp) + ((cur.y + end.y) / 2);
+
+            float ux = (x1p - cxp) / rx;
+            float uy = (y1p - cyp) / ry;
+            float wx = (-x1p - cxp) / rx;
+            float wy = (-y1p - cyp) / ry;
+            float theta = atan2(uy, ux);
+            float sweep = atan2((ux * wy) - (uy * wx), (ux * wx) + (uy * wy));
+            if ((v[4] == 0) && (sweep > 0))
+               sweep -= TWOPI;
+            else if ((v[4] != 0) && (sweep < 0))
+               sweep += TWOPI;
+
+            // angle step with a sagitta of tol on the larger radius
+            float r = std::max(rx, ry);
+            float step = (tol < r) ? 2 * acos(1 - (tol / r)) : PI / 2;
+            int n = static_cast<int>(ceil(fabs(sweep) / step));
+            n = std::min(std::max(n, 1), MAX_CURVE_SEGMENTS);
+            for (int i = 1; i < n; i++)
+            {
+               float t = theta + ((sweep * i) / n);
+               lineTo(Vector2(cx + (rx * cos(t) * cosPhi) - (ry * sin(t) * sinPhi),
+                              cy + (rx * cos(t) * sinPhi) + (ry * sin(t) * cosPhi)));
+            }
+            lineTo(end);
+            break;
+         }
+         case PATH_CLOSE:
+            endSubpath(true);
+            cur = start;
+            break;
+      }
+   }
+   endSubpath(false);
+
+   if (mbFilled && !mLoopSizes.empty())
    {
-      if (pLines[i]) pLines[i]->Draw();
-      if (pFans[i])  pFans [i]->Draw();
+      if (!Triangulator::Triangulate(mPoints, mLoopSizes, mTriangles))
+      {
+         addlog(Log::L_ERROR, "Path of %u points is self intersecting",
+                static_cast<unsigned int>(mPoints.size()));
+      }
    }
+   mbFlattened = true;
+}
+
+void CPath::Instantiate()
+{
+   if (!mbFlattened)
+      Flatten();
+
+   // pixel size in path units
+   float px, py;
+   PixelSize(px, py);
+   px /= fabsf(mfScale);
+   py /= fabsf(mfScale);
 
+   ShapeMesh mesh(mbAntialias, px, py);
+   if (mbFilled)
+   {
+      AddPolygon(mesh, mPoints, mLoopSizes, mTriangles);
+   }
+   else
+   {
+      // one pixel wide without a stroke width, the fringe does that when antialiased
+      float halfWidth = mStyle.strokeWidth / 2;
+      if (!mbAntialias)
+         halfWidth = std::max(halfWidth, std::min(px, py) / 2);
+      int first = 0;
+      for (size_t k = 0; k < mLoopSizes.size(); k++)
+      {
+         mesh.AddStroke(&mPoints[first], mLoopSizes[k], mClosed[k], halfWidth, WHITE);
+         first += mLoopSizes[k];
+      }
+   }
+
+   if (mesh.VertexCount() == 0)
+   {
+      ReleasePacket();
+      return;
+   }
+   if (!CreateMeshPacket(mesh))
+      return;
+   mpRenderPacket->mTransform[0] = mfScale;
+   mpRenderPacket->mTransform[5] = mfScale;
+   SetTranslation(mx0, my0);
+}
+
+void CPath::Draw()
+{
+   if (!mbFlattened)
+      Instantiate();
+   CShape::Draw();
 }
@@ -1,109 +1,371 @@
 #pragma once
 #include <stdint.h>
+#include <vector>
 #include <IPrimitive.h>
+#include "Color.h"
+#include "Gradient.h"
+#include "Style.h"
+#include "Vectors.h"
 class RenderPacket;
+class ShapeMesh;
 
-class CLine : public IPrimitive
+//! @brief Common base of the drawn shapes. Owns the render packet.
+class CShape : public IPrimitive
 {
 public:
-   CLine() { CLine(0,0,400,400, 2); }
-   CLine(float x0, float y0, float x1, float y1, float fWidth);
+   virtual ~CShape();
+
+   virtual void Draw() override;
+
+   //! @brief Draw the shape as a single quad with the SHAPE_SDF shader instead of
+   //! tessellating it. Must be set before Instantiate(). Ignored by shapes without an
+   //! SDF form (CFan, CPolygon).
+   //! @param[in] bSdf true for SDF mode.
+   void SetSdf(bool bSdf) { mbSdf = bSdf; }
+
+   //! @brief Add a one pixel antialiasing fringe around the tessellated edges (alpha falling
+   //! to zero) instead of drawing hard edges. Must be set before Instantiate(). SDF shapes
+   //! are always antialiased.
+   //! @param[in] bAntialias true for antialiased edges.
+   void SetAntialias(bool bAntialias) { mbAntialias = bAntialias; }
+
+   //! @brief Change the color (stroke color of lines and outlines, fill color otherwise).
+   //! Only the uColor uniform changes, the vertices are not touched.
+   //! @param[in] c New color.
+   void SetColor(const Color& c);
+
+   //! @brief Change the opacity. Only the uColor uniform changes.
+   //! @param[in] opacity Multiplied with the color alpha.
+   void SetOpacity(float opacity);
+
+   //! @brief Change the style. Outlines are regenerated in place if the stroke width changes.
+   //! @param[in] style New style.
+   void SetStyle(const Style& style);
+
+   const Style& GetStyle() const { return mStyle; }
+
+   //! @brief Fill (or stroke) with a gradient instead of the style color, computed by the
+   //! GRADIENT_FILL shader: only uniforms change (and the ramp texture for more than two
+   //! stops). The opacity still applies. Not available in SDF mode.
+   //! @param[in] g Gradient, in the coordinates of the shape vertices.
+   void SetGradient(const Gradient& g);
+   //! @brief Back to the style color.
+   void ClearGradient();
+
+protected:
+   //! @brief Constructor
+   //! @param[in] style Colors and stroke width.
+   //! @param[in] bStroked true if the shape is drawn with the stroke color.
+   CShape(const Style& style, bool bStroked);
+
+   //! @brief Compute mfColor (uColor) from the style.
+   void UpdateColor();
+
+   //! @brief Point a COLOR_FILL/GRADIENT_FILL packet at the current fill mode.
+   void ApplyGradient();
+
+   //! @brief Move the shape by its transform, the vertices are not touched.
+   //! In pixel space the translation is rounded to whole pixels.
+   //! @param[in] x,y Translation.
+   void SetTranslation(float x, float y);
+
+   //! @brief Snap the center of a line across its width in pixel space, so its edges fall
+   //! on pixel boundaries: on .5 for odd widths, on whole pixels for even widths.
+   //! @param[in] c Center coordinate.
+   //! @param[in] width Line width.
+   //! @return The snapped coordinate, c unchanged in clip space.
+   float SnapCenter(float c, float width) const;
+
+   //! @brief Keep the current render packet if it matches the requested layout, so the
+   //! caller can regenerate the vertices in place. Otherwise release it.
+   //! @return true if the packet is kept (and marked dirty).
+   bool ReusePacket(unsigned int program, unsigned int type, int vertexCount);
+
+   //! @brief Free the render packet and its buffers.
+   void ReleasePacket();
+
+   //! @brief Size of a screen pixel in shape units (1 in pixel space).
+   //! @param[out] px Pixel width.
+   //! @param[out] py Pixel height.
+   void PixelSize(float& px, float& py) const;
+
+   //! @brief Shape types understood by the SHAPE_SDF shader (uParams[0].x)
+   enum SdfType
+   {
+      SDF_CIRCLE = 0,
+      SDF_ARC,
+      SDF_BOX
+   };
+
+   //! @brief Create the render packet for COLOR_FILL vertices (3 pos, 4 color). An existing
+   //! packet with the same layout is reused.
+   //! @param[in] type GL primitive type.
+   //! @param[in] vertexCount Number of vertices to allocate.
+   void CreateFillPacket(unsigned int type, int vertexCount);
+
+   //! @brief Create the render packet for an indexed COLOR_FILL triangle list.
+   //! @param[in] mesh Vertices and indices to copy.
+   //! @return bool false if the mesh has more vertices than 16 bit indices address, the
+   //! packet is released and the shape isn't drawn.
+   bool CreateMeshPacket(const ShapeMesh& mesh);
+
+   //! @brief Create the render packet for a SHAPE_SDF quad. mfSdfParams must be filled in.
+   //! @param[in] cx,cy Center of the quad.
+   //! @param[in] ux,uy Unit vector of the local x axis.
+   //! @param[in] hx,hy Half size of the shape along the local axes (AA margin is added).
+   void CreateSdfPacket(float cx, float cy, float ux, float uy, float hx, float hy);
+
+   bool mbSdf;
+   bool mbAntialias;
+   bool mbStroked;
+   bool mbUsesWidth;  //!< The geometry depends on mStyle.strokeWidth
+   Style mStyle;
+   float mfColor[4];  //!< uColor, style color with opacity applied
+   float mfSdfParams[8];  //!< uParams for the SHAPE_SDF shader
+   bool mbGradient;
+   Gradient mGradient;
+   float mfGradientParams[16];  //!< uParams for the GRADIENT_FILL shader
+   unsigned int miGradientTexture;  //!< Ramp texture, 0 if not needed yet
+   std::vector<uint16_t> mIndices;
+};
+
+class CLine : public CShape
+{
+public:
+   CLine() : CLine(0, 0, 400, 400, 2) {}
+   CLine(float x0, float y0, float x1, float y1, float fWidth,
+         const Style& style = Style(Color(1.0f, 0.0f, 0.0f)));
    virtual ~CLine();
 
    virtual void Instantiate() override;
-   virtual void Draw() override;
+
+   //! @brief Move the line ends. Rewrites the vertices in place.
+   void SetEndpoints(float x0, float y0, float x1, float y1);
 
 protected:
    float x0;
    float y0;
    float x1;
    float y1;
-   float fWidth;
 };
 
-class CCircle : public IPrimitive
+class CCircle : public CShape
 {
 public:
    CCircle();
-   CCircle(float x0, float y0, float radius, int sides);
+   CCircle(float x0, float y0, float radius, int sides,
+           const Style& style = Style(Color(0.0f, 0.0f, 1.0f, 0.4f)));
    virtual ~CCircle();
 
    virtual void Instantiate() override;
-   virtual void Draw() override;
+
+   //! @brief Move the shape. Only changes the transform.
+   void SetCenter(float x, float y);
+   //! @brief Change the radius. Rewrites the vertices in place.
+   void SetRadius(float r);
 
 protected:
-   float x0; 
-   float y0; 
-   float radius; 
+   float x0;
+   float y0;
+   float radius;
    int sides;
 };
 
-class CCircleLine : public IPrimitive
+class CCircleLine : public CShape
 {
 public:
    CCircleLine();
-   CCircleLine(float x0, float y0, float radius, int sides);
+   CCircleLine(float x0, float y0, float radius, int sides,
+               const Style& style = Style(Color(0.0f, 1.0f, 1.0f)));
    virtual ~CCircleLine();
 
    virtual void Instantiate() override;
-   virtual void Draw() override;
+
+   //! @brief Move the shape. Only changes the transform.
+   void SetCenter(float x, float y);
+   //! @brief Change the radius. Rewrites the vertices in place.
+   void SetRadius(float r);
 
 protected:
    float mx0, my0;
    float mradius, msides;
-}; 
+};
 
-class CFanLine : public IPrimitive
+class CFanLine : public CShape
 {
 public:
    CFanLine();
-   CFanLine(float x0, float y0, float radius, int sides, float start, float stop);
+   CFanLine(float x0, float y0, float radius, int sides, float start, float stop,
+            const Style& style = Style(Color(0.0f, 1.0f, 1.0f)));
    virtual ~CFanLine();
 
    virtual void Instantiate() override;
-   virtual void Draw() override;
+
+   //! @brief Move the shape. Only changes the transform.
+   void SetCenter(float x, float y);
+   //! @brief Change the radius. Rewrites the vertices in place.
+   void SetRadius(float r);
 
 protected:
-   float mx0, my0; 
+   float mx0, my0;
    float mradius;
    int msides;
    float mstart, mstop;
 };
 
-class CFan : public IPrimitive
+class CFan : public CShape
 {
 public:
    CFan();
-   CFan(float x0, float y0, float radius, int sides, float start, float stop);
+   CFan(float x0, float y0, float radius, int sides, float start, float stop,
+        const Style& style = Style(Color(1.0f, 0.0f, 1.0f, 0.4f)));
    virtual ~CFan();
 
    virtual void Instantiate() override;
-   virtual void Draw() override;
+
+   //! @brief Move the shape. Only changes the transform.
+   void SetCenter(float x, float y);
+   //! @brief Change the radius. Rewrites the vertices in place.
+   void SetRadius(float r);
 
 protected:
-   float mx0, my0; 
-   float mradius; 
-   int msides; 
-   float mstart; 
+   float mx0, my0;
+   float mradius;
+   int msides;
+   float mstart;
    float mstop;
 };
 
-class CRoundRectangle : public IPrimitive
+class CRoundRectangle : public CShape
 {
 public:
    CRoundRectangle();
-   CRoundRectangle(float x0, float y0, float x1, float y1, float width);
+   //! @brief Rounded rectangle frame (or panel) drawn as a single mesh.
+   //! @param[in] x0,y0 Upper left corner of the frame centerline.
+   //! @param[in] x1,y1 Lower right corner of the frame centerline.
+   //! @param[in] width Frame width, also used as the outer corner radius. Seeds the stroke
+   //! width of the style, SetStyle() changes it.
+   //! @param[in] bFilled true to fill the whole rectangle instead of drawing the frame.
+   //! @param[in] style Stroke color for the frame, fill color when filled.
+   CRoundRectangle(float x0, float y0, float x1, float y1, float width, bool bFilled = false,
+                   const Style& style = Style(Color(1.0f, 0.0f, 0.0f)));
    virtual ~CRoundRectangle();
 
-   void Instantiate();
-   virtual void Draw();
+   virtual void Instantiate() override;
 
 protected:
-   CLine *pLines[4];
-   CFan *pFans[4];
+   float mx0, my0;
+   float mx1, my1;
+   bool mbFilled;
+};
 
+class CPolygon : public CShape
+{
+public:
+   //! @brief Filled polygon (concave allowed) with optional holes. The triangulation is
+   //! computed once and kept until the points change.
+   //! @param[in] points Outer boundary, either winding, no repeated closing point.
+   //! @param[in] holes Boundaries of the holes.
+   //! @param[in] style Fill color.
+   CPolygon(const std::vector<Vector2>& points,
+            const std::vector<std::vector<Vector2>>& holes = {},
+            const Style& style = Style(Color(0.0f, 1.0f, 0.0f, 0.6f)));
+   virtual ~CPolygon();
+
+   virtual void Instantiate() override;
+
+   //! @brief Move the polygon. Only changes the transform.
+   void SetPosition(float x, float y);
+   //! @brief Replace the points. The polygon is triangulated again.
+   void SetPoints(const std::vector<Vector2>& points,
+                  const std::vector<std::vector<Vector2>>& holes = {});
+
+protected:
+   std::vector<Vector2> mPoints;  //!< Outer boundary then the holes
+   std::vector<int> mLoopSizes;   //!< Points per loop
+   std::vector<uint16_t> mTriangles;  //!< Cached triangulation on mPoints
+   bool mbTriangulated;
    float mx0, my0;
-   float mx1, my1; 
-   float mwidth;
 };
 
+class CPath : public CShape
+{
+public:
+   //! @brief Path of lines, Bezier curves and elliptical arcs, stroked or filled. The
+   //! curves are flattened to polylines within a screen space tolerance, the result is kept
+   //! until the path or the scale changes.
+   //! @param[in] bFilled true to fill the path (the first subpath is the outline, the others
+   //! are holes), false to stroke it with the style stroke width (0 for one pixel).
+   //! @param[in] style Stroke or fill color and stroke width.
+   CPath(bool bFilled = false, const Style& style = Style(Color(1.0f, 1.0f, 0.0f)));
+   virtual ~CPath();
+
+   virtual void Instantiate() override;
+   //! @brief Regenerates the vertices first if the path was edited since the last draw.
+   virtual void Draw() override;
+
+   //! @brief Start a new subpath.
+   void MoveTo(float x, float y);
+   void LineTo(float x, float y);
+   //! @brief Quadratic Bezier from the current point.
+   //! @param[in] cx,cy Control point.
+   //! @param[in] x,y End point.
+   void QuadTo(float cx, float cy, float x, float y);
+   //! @brief Cubic Bezier from the current point.
+   //! @param[in] cx0,cy0 First control point.
+   //! @param[in] cx1,cy1 Second control point.
+   //! @param[in] x,y End point.
+   void CubicTo(float cx0, float cy0, float cx1, float cy1, float x, float y);
+   //! @brief Elliptical arc from the current point (SVG endpoint parameterization).
+   //! @param[in] rx,ry Radii.
+   //! @param[in] rotation Rotation of the x axis of the ellipse in degrees.
+   //! @param[in] bLargeArc true for the arc spanning more than 180 degrees.
+   //! @param[in] bSweep true to go in the positive angle direction (counter clockwise).
+   //! @param[in] x,y End point.
+   void ArcTo(float rx, float ry, float rotation, bool bLargeArc, bool bSweep, float x, float y);
+   //! @brief Join the current subpath back to its start.
+   void Close();
+   //! @brief Remove all subpaths.
+   void Clear();
+
+   //! @brief Move the path. Only changes the transform.
+   void SetPosition(float x, float y);
+   //! @brief Scale the path around its origin. The curves are flattened again for the new
+   //! size.
+   void SetScale(float scale);
+   //! @brief Maximum distance between the curves and their polylines.
+   //! @param[in] pixels Tolerance in screen pixels (default 0.25).
+   void SetTolerance(float pixels);
+
+protected:
+   enum PathOp
+   {
+      PATH_MOVE,
+      PATH_LINE,
+      PATH_QUAD,
+      PATH_CUBIC,
+      PATH_ARC,
+      PATH_CLOSE
+   };
+   struct PathCommand
+   {
+      PathOp op;
+      float v[7];
+   };
+
+   //! @brief Convert the commands to polylines (mPoints/mLoopSizes/mClosed).
+   void Flatten();
+   void AddCommand(PathOp op, float v0 = 0, float v1 = 0, float v2 = 0, float v3 = 0,
+                   float v4 = 0, float v5 = 0, float v6 = 0);
+
+   std::vector<PathCommand> mCommands;
+   std::vector<Vector2> mPoints;      //!< Flattened subpaths
+   std::vector<int> mLoopSizes;       //!< Points per subpath
+   std::vector<bool> mClosed;         //!< Subpath closed
+   std::vector<uint16_t> mTriangles;  //!< Cached fill triangulation on mPoints
+   bool mbFilled;
+   bool mbFlattened;
+   float mx0, my0;
+   float mfScale;
+   float mfTolerance;
+};
@@ -0,0 +1,225 @@
+#include "ShapeMesh.h"
+
+#include <algorithm>
+#include <math.h>
+
+// Longest miter allowed at sharp corners (in multiples of the offset)
+constexpr float MITER_LIMIT = 4.0f;
+
+ShapeMesh::ShapeMesh(bool bAntialias, float pixelX, float pixelY)
+   : mbAntialias(bAntialias), mPixelX(pixelX), mPixelY(pixelY)
+{
+}
+
+uint16_t ShapeMesh::AddVertex(float x, float y, const float* rgba)
+{
+   uint16_t index = static_cast<uint16_t>(VertexCount());
+   mVertices.push_back(x);
+   mVertices.push_back(y);
+   mVertices.push_back(0);
+   mVertices.push_back(rgba[0]);  // R
+   mVertices.push_back(rgba[1]);  // G
+   mVertices.push_back(rgba[2]);  // B
+   mVertices.push_back(rgba[3]);  // A
+   return index;
+}
+
+void ShapeMesh::AddTriangle(uint16_t a, uint16_t b, uint16_t c)
+{
+   mIndices.push_back(a);
+   mIndices.push_back(b);
+   mIndices.push_back(c);
+}
+
+void ShapeMesh::AddQuad(uint16_t a, uint16_t b, uint16_t c, uint16_t d)
+{
+   AddTriangle(a, b, c);
+   AddTriangle(a, c, d);
+}
+
+void ShapeMesh::AddFan(uint16_t center, uint16_t first, int count, bool bClosed)
+{
+   for (int i = 0; i < count - 1; i++)
+   {
+      AddTriangle(center, first + i, first + i + 1);
+   }
+   if (bClosed && (count > 2))
+   {
+      AddTriangle(center, first + count - 1, first);
+   }
+}
+
+Vector2 ShapeMesh::Normal(const Vector2* pts, int n, int i, bool bClosed, float sign) const
+{
+   int prev = (i > 0) ? i - 1 : (bClosed ? n - 1 : i);
+   int next = (i < n - 1) ? i + 1 : (bClosed ? 0 : i);
+
+   // normals of the edges into and out of this point
+   Vector2 n0, n1;
+   Vector2 e0 = pts[i] - pts[prev];
+   Vector2 e1 = pts[next] - pts[i];
+   if (e0.length() > 0)
+   {
+      e0.normalize();
+      n0.set(e0.y * sign, -e0.x * sign);
+   }
+   if (e1.length() > 0)
+   {
+      e1.normalize();
+      n1.set(e1.y * sign, -e1.x * sign);
+   }
+   if (prev == i)
+      n0 = n1;
+   if (next == i)
+      n1 = n0;
+
+   // miter: average normal scaled so the offset edges stay parallel
+   Vector2 m = (n0 + n1) * 0.5f;
+   float m2 = m.dot(m);
+   if (m2 > 0.000001f)
+   {
+      m = m * std::min(1.0f / m2, MITER_LIMIT);
+   }
+   return m;
+}
+
+uint16_t ShapeMesh::AddLoop(const Vector2* pts, int n, const float* rgba, bool bHole)
+{
+   uint16_t first = static_cast<uint16_t>(VertexCount());
+   if (!mbAntialias)
+   {
+      for (int i = 0; i < n; i++)
+      {
+         AddVertex(pts[i].x, pts[i].y, rgba);
+      }
+      return first;
+   }
+
+   // outward normal is (dy, -dx) for counter clockwise loops
+   float area = 0;
+   for (int i = 0; i < n; i++)
+   {
+      const Vector2& a = pts[i];
+      const Vector2& b = pts[(i + 1) % n];
+      area += (a.x * b.y) - (b.x * a.y);
+   }
+   float sign = (area >= 0) ? 1.0f : -1.0f;
+   if (bHole)
+      sign = -sign;
+
+   const float clear[4] = {rgba[0], rgba[1], rgba[2], 0};
+   std::vector<Vector2> normals(n);
+   for (int i = 0; i < n; i++)
+   {
+      normals[i] = Normal(pts, n, i, true, sign);
+      AddVertex(pts[i].x - (normals[i].x * mPixelX * 0.5f),
+                pts[i].y - (normals[i].y * mPixelY * 0.5f), rgba);
+   }
+   uint16_t fringe = static_cast<uint16_t>(VertexCount());
+   for (int i = 0; i < n; i++)
+   {
+      AddVertex(pts[i].x + (normals[i].x * mPixelX * 0.5f),
+                pts[i].y + (normals[i].y * mPixelY * 0.5f), clear);
+   }
+   for (int i = 0; i < n; i++)
+   {
+      int j = (i + 1) % n;
+      AddQuad(first + i, first + j, fringe + j, fringe + i);
+   }
+   return first;
+}
+
+void ShapeMesh::AddStroke(const Vector2* pts, int n, bool bClosed, float halfWidth,
+                          const float* rgba)
+{
+   if (n < 2)
+      return;
+
+   uint16_t first = static_cast<uint16_t>(VertexCount());
+   if (!mbAntialias)
+   {
+      // two vertices per point, one on each side
+      for (int i = 0; i < n; i++)
+      {
+         Vector2 m = Normal(pts, n, i, bClosed, 1.0f);
+         AddVertex(pts[i].x + (m.x * halfWidth), pts[i].y + (m.y * halfWidth), rgba);
+         AddVertex(pts[i].x - (m.x * halfWidth), pts[i].y - (m.y * halfWidth), rgba);
+      }
+      int segments = bClosed ? n : n - 1;
+      for (int i = 0; i < segments; i++)
+      {
+         uint16_t a = first + (i * 2);
+         uint16_t b = first + (((i + 1) % n) * 2);
+         AddQuad(a, b, b + 1, a + 1);
+      }
+      return;
+   }
+
+   // Lines thinner than a pixel are drawn one pixel wide with reduced alpha
+   float pixel = std::max(mPixelX, mPixelY);
+   float color[4] = {rgba[0], rgba[1], rgba[2], rgba[3]};
+   float core = halfWidth;      // core offset in shape units
+   float corePixels = -0.5f;    // plus core offset in pixels
+   float fringePixels = 0.5f;   // fringe offset in pixels (beyond halfWidth)
+   if (halfWidth < (pixel * 0.5f))
+   {
+      color[3] *= (halfWidth * 2.0f) / pixel;
+      if (halfWidth <= 0)
+         color[3] = rgba[3];
+      core = 0;
+      corePixels = 0;
+      fringePixels = 1.0f;
+   }
+   const float clear[4] = {rgba[0], rgba[1], rgba[2], 0};
+
+   // four vertices per point: outer fringe, outer core, inner core, inner fringe
+   for (int i = 0; i < n; i++)
+   {
+      Vector2 m = Normal(pts, n, i, bClosed, 1.0f);
+      Vector2 p = pts[i];
+
+      // pull the ends of open lines in by half a pixel and push the fringe out
+      Vector2 t;
+      if (!bClosed && ((i == 0) || (i == n - 1)))
+      {
+         t = (i == 0) ? pts[0] - pts[1] : pts[n - 1] - pts[n - 2];
+         if (t.length() > 0)
+            t.normalize();
+         t.x *= mPixelX * 0.5f;
+         t.y *= mPixelY * 0.5f;
+      }
+
+      Vector2 outerFringe(p.x + (m.x * (core + (fringePixels * mPixelX))) + t.x,
+                          p.y + (m.y * (core + (fringePixels * mPixelY))) + t.y);
+      Vector2 outerCore(p.x + (m.x * (core + (corePixels * mPixelX))) - t.x,
+                        p.y + (m.y * (core + (corePixels * mPixelY))) - t.y);
+      Vector2 innerCore(p.x - (m.x * (core + (corePixels * mPixelX))) - t.x,
+                        p.y - (m.y * (core + (corePixels * mPixelY))) - t.y);
+      Vector2 innerFringe(p.x - (m.x * (core + (fringePixels * mPixelX))) + t.x,
+                          p.y - (m.y * (core + (fringePixels * mPixelY))) + t.y);
+
+      AddVertex(outerFringe.x, outerFringe.y, clear);
+      AddVertex(outerCore.x, outerCore.y, color);
+      AddVertex(innerCore.x, innerCore.y, color);
+      AddVertex(innerFringe.x, innerFringe.y, clear);
+   }
+
+   int segments = bClosed ? n : n - 1;
+   for (int i = 0; i < segments; i++)
+   {
+      uint16_t a = first + (i * 4);
+      uint16_t b = first + (((i + 1) % n) * 4);
+      AddQuad(a, b, b + 1, a + 1);          // outer fringe
+      AddQuad(a + 1, b + 1, b + 2, a + 2);  // core
+      AddQuad(a + 2, b + 2, b + 3, a + 3);  // inner fringe
+   }
+
+   if (!bClosed)
+   {
+      // fringe across the butt caps
+      uint16_t s = first;
+      uint16_t e = first + ((n - 1) * 4);
+      AddQuad(s, s + 1, s + 2, s + 3);
+      AddQuad(e, e + 1, e + 2, e + 3);
+   }
+}
@@ -0,0 +1,65 @@
+#pragma once
+#include <stddef.h>
+#include <stdint.h>
+#include <vector>
+
+#include "Vectors.h"
+
+//! @brief Builds indexed COLOR_FILL triangle lists for the shapes, optionally with an
+//! antialiasing fringe: a one pixel wide band around every edge whose alpha falls from the
+//! shape color to zero (as done by NanoVG). Vertices are 3 floats for the pos, 4 for color.
+class ShapeMesh
+{
+public:
+   //! @brief Vertices addressable by the 16 bit indices, CShape doesn't draw larger meshes.
+   static constexpr size_t MAX_VERTICES = 65536;
+
+   //! @brief Constructor
+   //! @param[in] bAntialias true to generate the fringe
+   //! @param[in] pixelX Width of one pixel in shape units
+   //! @param[in] pixelY Height of one pixel in shape units
+   ShapeMesh(bool bAntialias, float pixelX, float pixelY);
+
+   //! @brief Add a single vertex.
+   //! @return Index of the vertex.
+   uint16_t AddVertex(float x, float y, const float* rgba);
+
+   //! @brief Add the boundary of a filled area. The interior must be triangulated by the
+   //! caller (AddTriangle/AddFan) on the n consecutive vertices returned. With antialiasing
+   //! these are pulled half a pixel inside and the fringe is added outside.
+   //! @param[in] pts Boundary points (either winding, no repeated closing point).
+   //! @param[in] n Number of points.
+   //! @param[in] rgba Color.
+   //! @param[in] bHole true if the area is on the outside of the loop (fringe goes inside).
+   //! @return Index of the first boundary vertex.
+   uint16_t AddLoop(const Vector2* pts, int n, const float* rgba, bool bHole = false);
+
+   //! @brief Add a stroked polyline (butt caps, mitered joins).
+   //! @param[in] pts Centerline points.
+   //! @param[in] n Number of points.
+   //! @param[in] bClosed true to join the last point back to the first.
+   //! @param[in] halfWidth Half the line width in shape units (0 for a one pixel line).
+   //! @param[in] rgba Color.
+   void AddStroke(const Vector2* pts, int n, bool bClosed, float halfWidth, const float* rgba);
+
+   //! @brief Add a triangle on existing vertices.
+   void AddTriangle(uint16_t a, uint16_t b, uint16_t c);
+
+   //! @brief Add a triangle fan around center over count consecutive vertices.
+   //! @param[in] bClosed true to also connect the last vertex back to the first.
+   void AddFan(uint16_t center, uint16_t first, int count, bool bClosed);
+
+   size_t VertexCount() const { return mVertices.size() / 7; }
+
+   std::vector<float> mVertices;
+   std::vector<uint16_t> mIndices;
+
+private:
+   //! @brief Mitered vertex normal of pts[i] (unit length along straight edges).
+   Vector2 Normal(const Vector2* pts, int n, int i, bool bClosed, float sign) const;
+   void AddQuad(uint16_t a, uint16_t b, uint16_t c, uint16_t d);
+
+   bool mbAntialias;
+   float mPixelX;
+   float mPixelY;
+};
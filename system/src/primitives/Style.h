@@ -0,0 +1,30 @@
+#pragma once
+#include "Color.h"
+
+//! @brief Drawing style of the shapes.
+//! @par The color is passed to the shader as a uniform (uColor), so changing it does not
+//! touch the vertices. Filled shapes use the fill color, lines and outlines the stroke color.
+struct Style
+{
+   //! @brief Style with the same fill and stroke color.
+   //! @param[in] c Fill and stroke color.
+   Style(const Color& c = Color(1.0f, 1.0f)) : fill(c), stroke(c), strokeWidth(0.0f), opacity(1.0f)
+   {
+   }
+
+   //! @brief Full constructor.
+   //! @param[in] f Fill color.
+   //! @param[in] s Stroke color.
+   //! @param[in] w Stroke width of lines and outlines, 0 for one pixel lines. CLine and
+   //! CRoundRectangle take theirs from the constructor.
+   //! @param[in] o Opacity, multiplied with the color alpha.
+   Style(const Color& f, const Color& s, float w, float o = 1.0f)
+      : fill(f), stroke(s), strokeWidth(w), opacity(o)
+   {
+   }
+
+   Color fill;
+   Color stroke;
+   float strokeWidth;
+   float opacity;
+};
@@ -0,0 +1,174 @@
+#include "TextMesh.h"
+
+#include "glad/glad.h"
+
+#include "ESShaderRepository.h"
+#include "Log.h"
+#include "RenderPacket.h"
+
+// Floats per vertex: 3 for the pos, 2 for the UVs
+constexpr unsigned int FLOATS_PER_VERTEX = 5;
+// Quads addressable with 16 bit indices
+constexpr size_t MAX_QUADS = 65536 / 4;
+
+TextMesh::TextMesh() : mpColor(nullptr)
+{
+   mOffset[0] = mOffset[1] = 0;
+}
+
+TextMesh::~TextMesh()
+{
+   for (Batch& b : mBatches)
+   {
+      if (b.pPacket)
+      {
+         // the vertices and indices belong to the batch
+         glDeleteBuffers(1, &b.pPacket->miVbo);
+         glDeleteBuffers(1, &b.pPacket->miIbo);
+         delete b.pPacket;
+      }
+   }
+}
+
+void TextMesh::Clear()
+{
+   for (Batch& b : mBatches)
+   {
+      b.mVertices.clear();
+      b.mIndices.clear();
+   }
+}
+
+TextMesh::Batch& TextMesh::GetBatch(uint32_t page)
+{
+   for (Batch& b : mBatches)
+   {
+      if (b.page == page)
+      {
+         return b;
+      }
+   }
+   mBatches.push_back(Batch());
+   mBatches.back().page = page;
+   mBatches.back().pPacket = nullptr;
+   return mBatches.back();
+}
+
+void TextMesh::AddQuads(const GlyphQuad* pQuads, size_t count, float x, float y, float sx,
+                        float sy)
+{
+   for (size_t i = 0; i < count; i++)
+   {
+      const GlyphQuad& q = pQuads[i];
+      Batch& b = GetBatch(q.page);
+      size_t first = b.mVertices.size() / FLOATS_PER_VERTEX;
+      if ((first / 4) >= MAX_QUADS)
+      {
+         addlog(Log::L_ERROR, "Too many glyphs in one text mesh\n");
+         return;
+      }
+
+      // UL, UR, LL, LR
+      const float xs[2] = {x + (q.x0 * sx), x + (q.x1 * sx)};
+      const float ys[2] = {y + (q.y0 * sy), y + (q.y1 * sy)};
+      const float us[2] = {q.u0, q.u1};
+      const float vs[2] = {q.v0, q.v1};
+      for (int corner = 0; corner < 4; corner++)
+      {
+         b.mVertices.push_back(xs[corner & 1]);
+         b.mVertices.push_back(ys[corner >> 1]);
+         b.mVertices.push_back(0);
+         b.mVertices.push_back(us[corner & 1]);  // U
+         b.mVertices.push_back(vs[corner >> 1]);  // V
+      }
+      const uint16_t v = static_cast<uint16_t>(first);
+      const uint16_t indices[6] = {v, uint16_t(v + 1), uint16_t(v + 2),
+                                   uint16_t(v + 2), uint16_t(v + 1), uint16_t(v + 3)};
+      b.mIndices.insert(b.mIndices.end(), indices, indices + 6);
+   }
+}
+
+void TextMesh::Commit(FontHandle font)
+{
+   for (Batch& b : mBatches)
+   {
+      if (!b.pPacket)
+      {
+         if (b.mIndices.empty())
+         {
+            continue;
+         }
+         b.pPacket = new RenderPacket();
+         // Init the render packet which will be passed to the scene graph on render.
+         b.pPacket->mMasterZ = 0.0f;
+         glGenBuffers(1, &b.pPacket->miVbo);
+         glGenBuffers(1, &b.pPacket->miIbo);
+         b.pPacket->miShaderProgram = ESShaderRepository::Instance().GetShaderProgram(
+            FontLibrary::instance().IsSdf(font) ? ESShaderRepository::FONT_SDF
+                                                : ESShaderRepository::FONT);
+         b.pPacket->mTransform.identity();
+         b.pPacket->miType = GL_TRIANGLES;
+
+         // shader (FONT)
+         b.pPacket->miVertArraySize = 3;
+         b.pPacket->miVertArrayOffset = 0;
+         b.pPacket->miTextureArraySize = 2;
+         b.pPacket->miTextureArrayOffset = 3;
+         b.pPacket->miColorArraySize = 0;
+         b.pPacket->miColorArrayOffset = 0;
+         b.pPacket->miVertexStride = FLOATS_PER_VERTEX * sizeof(GLfloat);
+         b.pPacket->miIndexType = GL_UNSIGNED_SHORT;
+      }
+
+      // the atlas may have grown a page since the last commit
+      b.pPacket->miTexture = FontLibrary::instance().AtlasTexture(font, b.page);
+      b.pPacket->mfUniformArray = mpColor;
+      b.pPacket->mTransform[12] = mOffset[0];
+      b.pPacket->mTransform[13] = mOffset[1];
+
+      b.pPacket->miVertexCount = static_cast<unsigned int>(b.mVertices.size() / FLOATS_PER_VERTEX);
+      b.pPacket->mfVertices = b.mVertices.data();
+      b.pPacket->MarkDirty();
+      b.pPacket->miIndexCount = static_cast<unsigned int>(b.mIndices.size());
+      b.pPacket->mpIndices = b.mIndices.data();
+      b.pPacket->mbIndicesDirty = true;
+   }
+}
+
+void TextMesh::SetColor(const float* pRGBA)
+{
+   mpColor = pRGBA;
+   for (Batch& b : mBatches)
+   {
+      if (b.pPacket)
+      {
+         b.pPacket->mfUniformArray = mpColor;
+      }
+   }
+}
+
+void TextMesh::SetOffset(float dx, float dy)
+{
+   mOffset[0] = dx;
+   mOffset[1] = dy;
+   for (Batch& b : mBatches)
+   {
+      if (b.pPacket)
+      {
+         b.pPacket->mTransform[12] = dx;
+         b.pPacket->mTransform[13] = dy;
+      }
+   }
+}
+
+void TextMesh::Draw()
+{
+   for (Batch& b : mBatches)
+   {
+      // an empty batch would draw its vertices in order
+      if (b.pPacket && (b.pPacket->miIndexCount > 0))
+      {
+         b.pPacket->Render();
+      }
+   }
+}
@@ -0,0 +1,64 @@
+#ifndef TEXT_MESH_H
+#define TEXT_MESH_H
+#include <stddef.h>
+#include <stdint.h>
+#include <vector>
+
+#include "FontLibrary.h"
+
+class RenderPacket;
+
+//! @brief Builds the FONT (or FONT_SDF) shader packets of laid out text: indexed quads from
+//! the glyph atlas, one packet per atlas page (usually one). Vertices are 3 floats for the
+//! pos, 2 for the UVs, the color is the uColor uniform.
+//! @par The packets are kept by Clear(), rebuilding text of the same length only uploads
+//! the vertices again.
+class TextMesh
+{
+public:
+   TextMesh();
+   ~TextMesh();
+
+   //! @brief Remove all quads (the packets are kept for the next Commit()).
+   void Clear();
+
+   //! @brief Add glyph quads, mapped to the screen as (x + qx * sx, y + qy * sy).
+   //! @param[in] pQuads Quads from FontLibrary::BuildQuads().
+   //! @param[in] count Number of quads.
+   //! @param[in] x,y Screen position of the upper left of the text.
+   //! @param[in] sx,sy Screen units per text pixel (sy < 0 when screen y is up).
+   void AddQuads(const GlyphQuad* pQuads, size_t count, float x, float y, float sx, float sy);
+
+   //! @brief Create or update the render packets after adding quads.
+   //! @param[in] font Font the quads were laid out with (selects the atlas).
+   void Commit(FontHandle font);
+
+   //! @brief Text color (uColor), the array must outlive the mesh.
+   void SetColor(const float* pRGBA);
+
+   //! @brief Move the whole text by its transform, the vertices are not touched.
+   void SetOffset(float dx, float dy);
+
+   void Draw();
+
+   TextMesh(const TextMesh&) = delete;
+   TextMesh& operator=(const TextMesh&) = delete;
+
+private:
+   //! @brief Quads of one atlas page.
+   struct Batch
+   {
+      uint32_t page;
+      std::vector<float> mVertices;
+      std::vector<uint16_t> mIndices;
+      RenderPacket* pPacket;
+   };
+
+   Batch& GetBatch(uint32_t page);
+
+   std::vector<Batch> mBatches;
+   const float* mpColor;
+   float mOffset[2];
+};
+
+#endif  // TEXT_MESH_H
@@ -0,0 +1,250 @@
+#include "Triangulator.h"
+
+#include <algorithm>
+
+namespace
+{
+   // Twice the signed area of abc, > 0 for counter clockwise
+   inline float Cross(const Vector2& a, const Vector2& b, const Vector2& c)
+   {
+      return ((b.x - a.x) * (c.y - a.y)) - ((b.y - a.y) * (c.x - a.x));
+   }
+
+   inline bool Same(const Vector2& a, const Vector2& b)
+   {
+      return (a.x == b.x) && (a.y == b.y);
+   }
+
+   // p inside or on the counter clockwise triangle abc
+   inline bool InTriangle(const Vector2& a, const Vector2& b, const Vector2& c, const Vector2& p)
+   {
+      return (Cross(a, b, p) >= 0) && (Cross(b, c, p) >= 0) && (Cross(c, a, p) >= 0);
+   }
+
+   float SignedArea(const std::vector<Vector2>& pts, int first, int count)
+   {
+      float area = 0;
+      for (int i = 0; i < count; i++)
+      {
+         const Vector2& a = pts[first + i];
+         const Vector2& b = pts[first + ((i + 1) % count)];
+         area += (a.x * b.y) - (b.x * a.y);
+      }
+      return area;
+   }
+
+   // Loop indices first..first+count in the requested winding
+   std::vector<uint16_t> Loop(const std::vector<Vector2>& pts, int first, int count, bool bCcw)
+   {
+      std::vector<uint16_t> loop(count);
+      for (int i = 0; i < count; i++)
+      {
+         loop[i] = static_cast<uint16_t>(first + i);
+      }
+      if ((SignedArea(pts, first, count) > 0) != bCcw)
+      {
+         std::reverse(loop.begin(), loop.end());
+      }
+      return loop;
+   }
+
+   // Index in the hole of its rightmost vertex (lowest y on ties)
+   size_t Rightmost(const std::vector<Vector2>& pts, const std::vector<uint16_t>& hole)
+   {
+      size_t m = 0;
+      for (size_t i = 1; i < hole.size(); i++)
+      {
+         const Vector2& v = pts[hole[i]];
+         const Vector2& best = pts[hole[m]];
+         if ((v.x > best.x) || ((v.x == best.x) && (v.y < best.y)))
+            m = i;
+      }
+      return m;
+   }
+
+   // p strictly inside the interior angle of the counter clockwise loop at v
+   inline bool InCone(const Vector2& prev, const Vector2& v, const Vector2& next, const Vector2& p)
+   {
+      if (Cross(prev, v, next) >= 0)
+         return (Cross(prev, v, p) > 0) && (Cross(v, next, p) > 0);
+      return (Cross(prev, v, p) > 0) || (Cross(v, next, p) > 0);
+   }
+
+   // Join a clockwise hole to the counter clockwise polygon with a pair of bridge edges
+   void Bridge(const std::vector<Vector2>& pts, std::vector<uint16_t>& poly,
+               const std::vector<uint16_t>& hole)
+   {
+      size_t m = Rightmost(pts, hole);
+      const Vector2& M = pts[hole[m]];
+
+      // closest edge hit by the ray from M towards +x
+      size_t n = poly.size();
+      size_t best = n;
+      float bestX = 0;
+      for (size_t i = 0; i < n; i++)
+      {
+         const Vector2& a = pts[poly[i]];
+         const Vector2& b = pts[poly[(i + 1) % n]];
+         if ((a.y > M.y) == (b.y > M.y))
+            continue;
+         float x = a.x + (((M.y - a.y) * (b.x - a.x)) / (b.y - a.y));
+         if ((x >= M.x) && ((best == n) || (x < bestX)))
+         {
+            best = i;
+            bestX = x;
+         }
+      }
+      if (best == n)
+         return;  // hole outside the polygon
+
+      // candidate P: the edge end with the larger x
+      Vector2 P = pts[poly[best]];
+      if (pts[poly[(best + 1) % n]].x > P.x)
+         P = pts[poly[(best + 1) % n]];
+      Vector2 I(bestX, M.y);
+
+      // any vertex inside MIP could hide P, the one closest in angle to the ray (then in
+      // distance) is visible. Bridge duplicates share their position, so all the vertices are
+      // tested rather than the reflex ones only, whose reflexness the duplicates change
+      if (!Same(P, I))
+      {
+         float bestTan = -1;
+         float bestDist = 0;
+         Vector2 target = P;
+         for (size_t i = 0; i < n; i++)
+         {
+            const Vector2& v = pts[poly[i]];
+            if (Same(v, P) || (v.x < M.x))
+               continue;
+            bool bInside = (P.y < M.y) ? InTriangle(M, P, I, v) : InTriangle(M, I, P, v);
+            if (!bInside)
+               continue;
+            float dx = v.x - M.x;
+            float t = (dx > 0) ? std::fabs(v.y - M.y) / dx : 1e30f;
+            float dist = (dx * dx) + ((v.y - M.y) * (v.y - M.y));
+            if ((bestTan < 0) || (t < bestTan) || ((t == bestTan) && (dist < bestDist)))
+            {
+               bestTan = t;
+               bestDist = dist;
+               target = v;
+            }
+         }
+         P = target;
+      }
+
+      // P is in the loop once per bridge already ending there, join at the copy whose
+      // corner M is seen from
+      size_t p = n;
+      for (size_t i = 0; i < n; i++)
+      {
+         if (!Same(pts[poly[i]], P))
+            continue;
+         if ((p == n) ||
+             InCone(pts[poly[(i + n - 1) % n]], pts[poly[i]], pts[poly[(i + 1) % n]], M))
+         {
+            p = i;
+         }
+      }
+
+      // poly[..p], M, hole from M around back to M, poly[p..]
+      std::vector<uint16_t> joined;
+      joined.reserve(n + hole.size() + 2);
+      joined.insert(joined.end(), poly.begin(), poly.begin() + p + 1);
+      for (size_t i = 0; i <= hole.size(); i++)
+      {
+         joined.push_back(hole[(m + i) % hole.size()]);
+      }
+      joined.insert(joined.end(), poly.begin() + p, poly.end());
+      poly.swap(joined);
+   }
+}
+
+bool Triangulator::Triangulate(const std::vector<Vector2>& pts,
+                               const std::vector<int>& loopSizes,
+                               std::vector<uint16_t>& indices)
+{
+   indices.clear();
+   if (loopSizes.empty() || (loopSizes[0] < 3))
+      return false;
+
+   std::vector<uint16_t> poly = Loop(pts, 0, loopSizes[0], true);
+
+   // holes
+   std::vector<std::vector<uint16_t>> holes;
+   int first = loopSizes[0];
+   for (size_t h = 1; h < loopSizes.size(); h++)
+   {
+      if (loopSizes[h] >= 3)
+         holes.push_back(Loop(pts, first, loopSizes[h], false));
+      first += loopSizes[h];
+   }
+   // rightmost vertex first, lowest first on ties: the ray of a later hole can only meet
+   // the bridges of the earlier ones, which are in the loop by then
+   std::sort(holes.begin(), holes.end(),
+             [&pts](const std::vector<uint16_t>& a, const std::vector<uint16_t>& b) {
+                const Vector2& ma = pts[a[Rightmost(pts, a)]];
+                const Vector2& mb = pts[b[Rightmost(pts, b)]];
+                return (ma.x > mb.x) || ((ma.x == mb.x) && (ma.y < mb.y));
+             });
+   for (const std::vector<uint16_t>& hole : holes)
+   {
+      Bridge(pts, poly, hole);
+   }
+
+   // clip ears
+   indices.reserve((poly.size() - 2) * 3);
+   bool bOk = true;
+   size_t i = 0;
+   size_t misses = 0;
+   while (poly.size() > 3)
+   {
+      size_t n = poly.size();
+      uint16_t ia = poly[(i + n - 1) % n];
+      uint16_t ib = poly[i];
+      uint16_t ic = poly[(i + 1) % n];
+      const Vector2& a = pts[ia];
+      const Vector2& b = pts[ib];
+      const Vector2& c = pts[ic];
+
+      float area = Cross(a, b, c);
+      bool bEar = (area > 0);
+      for (size_t j = 0; bEar && (j < n); j++)
+      {
+         const Vector2& v = pts[poly[j]];
+         // the corners and their bridge duplicates don't block the ear
+         if (Same(v, a) || Same(v, b) || Same(v, c))
+            continue;
+         bEar = !InTriangle(a, b, c, v);
+      }
+
+      // collinear points are dropped without a triangle, a full pass without an ear
+      // means the polygon self intersects: clip anyway so the loop ends
+      if (bEar || (area == 0) || (misses >= n))
+      {
+         if (area > 0)
+         {
+            indices.push_back(ia);
+            indices.push_back(ib);
+            indices.push_back(ic);
+         }
+         if (!bEar && (area != 0))
+            bOk = false;
+         poly.erase(poly.begin() + i);
+         if (i >= poly.size())
+            i = 0;
+         misses = 0;
+      }
+      else
+      {
+         i = (i + 1) % n;
+         misses++;
+      }
+   }
+   if (Cross(pts[poly[0]], pts[poly[1]], pts[poly[2]]) > 0)
+   {
+      indices.push_back(poly[0]);
+      indices.push_back(poly[1]);
+      indices.push_back(poly[2]);
+   }
+   return bOk;
+}
@@ -0,0 +1,23 @@
+#pragma once
+#include <stdint.h>
+#include <vector>
+
+#include "Vectors.h"
+
+//! @brief Ear clipping triangulation of simple polygons (concave allowed) with holes.
+//! @par Holes are joined to the outer boundary by bridge edges (Eberly, "Triangulation by
+//! Ear Clipping"), then ears are clipped from the single resulting loop. Runs in O(n^2),
+//! so the shapes call it once and keep the index list.
+class Triangulator
+{
+public:
+   //! @brief Triangulate a polygon
+   //! @param[in] pts Points of all loops, the outer boundary first, then each hole
+   //! (either winding, no repeated closing point).
+   //! @param[in] loopSizes Number of points of each loop.
+   //! @param[out] indices Triangle list on pts (replaced).
+   //! @return bool true for success, false if the polygon is degenerate (the triangles
+   //! found so far are kept).
+   static bool Triangulate(const std::vector<Vector2>& pts, const std::vector<int>& loopSizes,
+                           std::vector<uint16_t>& indices);
+};
@@ -0,0 +1,91 @@
+#include "VisualDynamicText.h"
+#include "Screen.h"
+#include "Widget.h"
+
+namespace BaxGUI
+{
+   VisualDynamicText::VisualDynamicText(Widget* pParent)
+      : IVisual(pParent), mFont(NO_FONT), mLayoutX(0), mLayoutY(0), mbInstantiated(false)
+   {
+   }
+   VisualDynamicText::~VisualDynamicText() {}
+
+   // *** Derived classes must provide pure virtual methods
+   bool VisualDynamicText::Instantiate(bool bActivate)
+   {
+      if (bActivate && !mFont)
+      {
+         mFont = FontLibrary::instance().Find(mFontName.c_str());
+      }
+      if (bActivate && mFont)
+      {
+         // screen units per text pixel (-y is down on the screen)
+         float sx = 2.0f / (float)(mpParent->GetParent()->LogicalWidth());
+         float sy = 2.0f / (float)(mpParent->GetParent()->LogicalHeight());
+         mMesh.SetPlacement(mScreen.x, mScreen.y, sx, -sy);
+         mMesh.SetColor(mColor.FloatArray());
+         mLayoutX = mScreen.x;
+         mLayoutY = mScreen.y;
+         mMesh.SetOffset(0, 0);
+         mbInstantiated = true;
+         Relayout();
+      }
+      else
+      {
+         mMesh.Update(NULL, 0, mFont);
+         mbInstantiated = false;
+      }
+      return true;
+   }
+
+   void VisualDynamicText::SetText(const char* pContent)
+   {
+      if (mContent == pContent)
+      {
+         return;
+      }
+      mContent = pContent;
+      if (mbInstantiated)
+      {
+         Relayout();
+      }
+   }
+
+   void VisualDynamicText::Relayout()
+   {
+      FontLibrary& rFonts = FontLibrary::instance();
+      if (rFonts.Layout(mContent.c_str(), mFont, mRun) && rFonts.BuildQuads(mRun, mFont, mQuads))
+      {
+         mMesh.Update(mQuads.data(), mQuads.size(), mFont);
+      }
+   }
+
+   void VisualDynamicText::Update(float fTime) {}
+
+   void VisualDynamicText::Draw()
+   {
+      if (mbInstantiated)
+      {
+         mMesh.Draw();
+      }
+   }
+
+   void VisualDynamicText::Move(float x, float y)
+   {
+      // move the slots by their transform, nothing is rewritten
+      mMesh.SetOffset(x - mLayoutX, y - mLayoutY);
+      IVisual::Move(x, y);
+   }
+
+   VisualDynamicText* VisualDynamicText::createDynamicText(Widget* pParent, const ScreenRect& r,
+                                                           const Color& c, const char* pFontSpec,
+                                                           const char* pContent)
+   {
+      VisualDynamicText* pText = new VisualDynamicText(pParent);
+      pText->Resize(r);
+      pText->mFontName = pFontSpec;
+      pText->mColor = c;
+      pText->mContent = pContent;
+      return pText;
+   }
+}
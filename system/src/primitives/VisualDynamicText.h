@@ -0,0 +1,61 @@
+#ifndef VISUAL_DYNAMIC_TEXT_H
+#define VISUAL_DYNAMIC_TEXT_H
+#include <string>
+#include <vector>
+#include <stdint.h>
+
+#include "IVisual.h"
+#include "Color.h"
+#include "DynamicTextMesh.h"
+#include "FontLibrary.h"
+
+namespace BaxGUI
+{
+   class Widget;
+
+   //! @brief Text changed every frame (live values, timers): SetText() lays out the new
+   //! string and uploads only the glyph quads that differ from the ones shown.
+   //! @par The text is drawn at one text pixel per logical pixel from the upper left of
+   //! its rectangle, it is not stretched to it: a value getting longer does not rescale
+   //! the others. With tabular digits (most fonts) a changed digit is one quad.
+   class VisualDynamicText : public IVisual
+   {
+     protected:
+      //! @brief Only factory methods can construct Visual objects.
+      VisualDynamicText(Widget* pParent);
+
+     public:
+      virtual ~VisualDynamicText();
+      // *** Derived classes must provide pure virtual methods
+      virtual bool Instantiate(bool bActivate);
+      virtual void Update(float fTime);
+      virtual void Draw();
+
+      virtual void Move(float x, float y);
+
+      //! @brief Change the text
+      //! @param[in] pContent UTF-8 string
+      void SetText(const char* pContent);
+
+      static VisualDynamicText* createDynamicText(Widget* pParent, const ScreenRect& r,
+                                                  const Color& c, const char* pFontSpec,
+                                                  const char* pContent);
+
+     private:
+      //! @brief Lay out mContent and update the changed quads
+      void Relayout();
+
+      std::string mFontName;
+      FontHandle mFont;  //!< mFontName, looked up by the first Instantiate()
+      Color mColor;
+      std::string mContent;
+
+      GlyphRun mRun;                  //!< Scratch, reused by every SetText()
+      std::vector<GlyphQuad> mQuads;  //!< Scratch, reused by every SetText()
+      DynamicTextMesh mMesh;
+      float mLayoutX, mLayoutY;  //!< Position the slots were written at
+      bool mbInstantiated;
+   };
+}
+
+#endif  // VISUAL_DYNAMIC_TEXT_H
@@ -2,11 +2,11 @@
 #define VISUAL_TEXT_H
 #include <string>
 #include <stdint.h>
-#include <GLES2/gl2.h>
 
 #include "IVisual.h"
 #include "Color.h"
-class RenderPacket;
+#include "TextCache.h"
+#include "TextMesh.h"
 
 namespace BaxGUI
 {
@@ -28,16 +28,18 @@ namespace BaxGUI
       static VisualText* createText(Widget* pParent, const ScreenRect& r, const Color& c, const char* pFontSpec, const char* pContent, bool bTrim);
      private:
 
-      RenderPacket* mpRenderPacket;
+      //! @brief Map the glyph quads into mScreen
       void LoadVertexData();
-      std::string msFilename;
 
       std::string mFontName;
+      FontHandle mFont;  //!< mFontName, looked up by the first Instantiate()
       Color mColor;
       std::string mContent;
 
-      uint32_t w,h;
-      GLuint mOGLHandle;
+      const TextCache::Entry* mpLayout;  //!< Shared layout, one quad per glyph
+      TextMesh mMesh;
+      ScreenRect mLoaded;             //!< mScreen the vertices were built for
+      bool mbInstantiated;
 
       bool mbTrim;
    };
@@ -1,104 +1,129 @@
 #include "VisualWWText.h"
 #include "FontLibrary.h"
 #include "Screen.h"
-#include "Tokenize.h"
-#include "VisualText.h"
 #include "Widget.h"
 
 #include "Log.h"
 
 namespace BaxGUI
 {
-   VisualWWText::VisualWWText(Widget* pParent) : IVisual(pParent) {}
-   VisualWWText::~VisualWWText()
+   VisualWWText::VisualWWText(Widget* pParent)
+      : IVisual(pParent), mFont(NO_FONT), mLayoutX(0), mLayoutY(0)
    {
-      // Free the renders
-      while (mRenders.begin() != mRenders.end())
-      {
-         delete *mRenders.begin();
-         mRenders.erase(mRenders.begin());
-      }
    }
+   VisualWWText::~VisualWWText() {}
+
    // *** Derived classes must provide pure virtual methods
    bool VisualWWText::Instantiate(bool bActivate)
    {
-      if (bActivate)
+      mMesh.Clear();
+      if (bActivate && !mFont)
+      {
+         mFont = FontLibrary::instance().Find(mFontName.c_str());
+      }
+      if (bActivate && mFont)
       {
-         float hspace = (float)(FontLibrary::instance().CharWidth(mFontName.c_str(), 32)) /
-            (float)(mpParent->GetParent()->LogicalWidth()) * 2.0f;
-         float vspace = 1.0f / (float)(mpParent->GetParent()->LogicalHeight());
+         // screen units per text pixel
+         float sx = 2.0f / (float)(mpParent->GetParent()->LogicalWidth());
+         float sy = 2.0f / (float)(mpParent->GetParent()->LogicalHeight());
+         int32_t maxWidth = static_cast<int32_t>((mScreen.w / sx) * 64.0f);
 
-         // create renders of all the tokens
-         ScreenRect r(mScreen.x, mScreen.y, 0, 0);
-         std::list<std::string>::iterator it = mTokens.begin();
-         while (it != mTokens.end())
+         // one layout per paragraph, the lines are broken on its glyph positions
+         FontLibrary& rFonts = FontLibrary::instance();
+         GlyphRun run;
+         float y = mScreen.y;
+         size_t start = 0;
+         while (start <= mContent.size())
          {
-            VisualText* pText =
-               VisualText::createText(mpParent, r, mColor, mFontName.c_str(), (*it).c_str(), true);
-            pText->Instantiate(true);
-            // Get the actual position of the text for testing and for next token
-            r = pText->Screen();
-            // if new text is outside of bounds, reset the location to the next line
-            float right = mScreen.x + mScreen.w;
-            if ((r.x >= right) || ((r.x + r.w) > right))
+            size_t end = mContent.find('\n', start);
+            if (end == std::string::npos)
             {
-               r.x = mScreen.x;
-               r.y -= r.h + vspace;  // -y is down on the screen
-               pText->Resize(r);
+               end = mContent.size();
             }
-            // always advance
-            r.x += r.w + hspace;
-
-            mRenders.push_back(pText);
-            ++it;
+            std::string paragraph = mContent.substr(start, end - start);
+            if (!rFonts.Layout(paragraph.c_str(), mFont, run))
+            {
+               break;
+            }
+            AddParagraph(run, maxWidth, sx, sy, y);
+            start = end + 1;
          }
+         std::vector<GlyphQuad>().swap(mQuads);
+
+         mMesh.SetColor(mColor.FloatArray());
+         mLayoutX = mScreen.x;
+         mLayoutY = mScreen.y;
+         mMesh.SetOffset(0, 0);
       }
-      else
+      mMesh.Commit(mFont);
+      return true;
+   }
+
+   void VisualWWText::AddParagraph(const GlyphRun& run, int32_t maxWidth, float sx, float sy,
+                                   float& y)
+   {
+      size_t count = run.glyphs.size();
+      size_t first = 0;     // first glyph of the line
+      size_t lastSpace = 0;  // last break opportunity of the line (0 for none)
+      for (size_t i = 0; i < count; i++)
       {
-         // Free the renders
-         while (mRenders.begin() != mRenders.end())
+         if (run.glyphs[i].codepoint == ' ')
          {
-            delete *mRenders.begin();
-            mRenders.erase(mRenders.begin());
+            lastSpace = i;
+            continue;
+         }
+
+         // right of this glyph: the next pen position (end of the text for the last)
+         int32_t right = (i + 1 < count) ? run.glyphs[i + 1].x : static_cast<int32_t>(run.w << 6);
+         if (((right - run.glyphs[first].x) > maxWidth) && (lastSpace > first))
+         {
+            // wrap at the last space, the word it ends moves to the next line
+            AddLine(run, first, lastSpace, y, sx, sy);
+            y -= (run.h + 1) * sy;  // -y is down on the screen
+            first = lastSpace + 1;
+            lastSpace = 0;
          }
       }
-      return true;
+      AddLine(run, first, count, y, sx, sy);
+      y -= (run.h + 1) * sy;
    }
 
-   void VisualWWText::Update(float fTime)
+   void VisualWWText::AddLine(const GlyphRun& run, size_t first, size_t last, float y, float sx,
+                              float sy)
    {
-      // Update all the renders (in case we need to do something)
-      std::list<VisualText*>::iterator it = mRenders.begin();
-      while (it != mRenders.end())
+      if (first >= last)
+      {
+         return;
+      }
+
+      // the line starts at the left edge
+      GlyphRun line;
+      line.glyphs.assign(run.glyphs.begin() + first, run.glyphs.begin() + last);
+      int32_t left = line.glyphs.front().x;
+      for (GlyphPosition& position : line.glyphs)
+      {
+         position.x -= left;
+      }
+      line.w = 0;
+      line.h = run.h;
+      if (FontLibrary::instance().BuildQuads(line, mFont, mQuads))
       {
-         (*it)->Update(fTime);
-         ++it;
+         mMesh.AddQuads(mQuads.data(), mQuads.size(), mScreen.x, y, sx, -sy);
       }
    }
 
+   void VisualWWText::Update(float fTime) {}
+
    void VisualWWText::Draw()
    {
-      // Draw all the renders
-      std::list<VisualText*>::iterator it = mRenders.begin();
-      while (it != mRenders.end())
-      {
-         (*it)->Draw();
-         ++it;
-      }
+      // the whole paragraph is one mesh
+      mMesh.Draw();
    }
 
    void VisualWWText::Move(float x, float y)
    {
-      float dx = x - mScreen.x;
-      float dy = y - mScreen.y;
-      // move all the renders
-      std::list<VisualText*>::iterator it = mRenders.begin();
-      while (it != mRenders.end())
-      {
-         (*it)->Move((*it)->Screen().x + dx, (*it)->Screen().y + dy);
-         ++it;
-      }
-
+      // move the mesh by its transform, no new layout
+      mMesh.SetOffset(x - mLayoutX, y - mLayoutY);
       IVisual::Move(x, y);
    }
 
@@ -111,8 +136,6 @@ namespace BaxGUI
       pRet->mColor = c;
       pRet->mContent = pContent;
 
-      int32_t count = Tokenize(pContent, pRet->mTokens);
-
       return pRet;
    }
 }
@@ -1,19 +1,17 @@
 #ifndef VISUAL_WW_TEXT_H
 #define VISUAL_WW_TEXT_H
 #include <string>
-#include <list>
+#include <vector>
 #include <stdint.h>
-#include <GLES2/gl2.h>
 
 #include "IVisual.h"
 #include "Color.h"
-
-class RenderPacket;
+#include "FontLibrary.h"
+#include "TextMesh.h"
 
 namespace BaxGUI
 {
    class Widget;
-   class VisualText;
 
    class VisualWWText : public IVisual
    {
@@ -33,11 +31,24 @@ namespace BaxGUI
       static VisualWWText* createWWText(Widget* pParent, const ScreenRect& r, const Color& c, const char* pFontSpec, const char* pContent, bool bTrim);
 
      private:
+      //! @brief Break a laid out paragraph into lines of at most maxWidth and add them to
+      //! the mesh
+      //! @param[in] run Paragraph
+      //! @param[in] maxWidth Line width (26.6 fixed point pixels)
+      //! @param[in] sx,sy Screen units per text pixel
+      //! @param[in,out] y Top of the next line (screen units)
+      void AddParagraph(const GlyphRun& run, int32_t maxWidth, float sx, float sy, float& y);
+      //! @brief Add the glyphs [first, last) of a paragraph as one line
+      void AddLine(const GlyphRun& run, size_t first, size_t last, float y, float sx, float sy);
+
       std::string mFontName;
+      FontHandle mFont;  //!< mFontName, looked up by the first Instantiate()
       Color mColor;
       std::string mContent;
-      std::list<std::string> mTokens;
-      std::list<VisualText*> mRenders;
+
+      TextMesh mMesh;                 //!< All the lines, one packet per atlas page
+      std::vector<GlyphQuad> mQuads;  //!< Scratch for the line quads
+      float mLayoutX, mLayoutY;       //!< Position the mesh was built at
    };
 }
 
@@ -0,0 +1,118 @@
+// Animator regression test: the transform a primitive sets on its packet after (or while)
+// it is animated must not be undone by the next Update(), a packet created again must get
+// the animated state back.
+#include <math.h>
+#include <stdio.h>
+
+#include "Animator.h"
+#include "IPlatform.h"
+#include "IPrimitive.h"
+#include "RenderPacket.h"
+
+namespace
+{
+   // 1024x768 window, time driven by the test
+   class TestPlatform : public IPlatform
+   {
+     public:
+      bool ShouldExit() override { return false; }
+      void HandleEvents() override {}
+      void FrameBegin() override {}
+      void FrameEnd() override {}
+      void Terminate() override {}
+      bool Ready() override { return true; }
+      double CurrentTime() override { return 0; }
+      uint32_t ScreenPixelWidth() override { return 1024; }
+      uint32_t ScreenPixelHeight() override { return 768; }
+   };
+
+   // Moves its packet like CShape::SetTranslation(), no GL
+   class TestShape : public IPrimitive
+   {
+     public:
+      ~TestShape() override { delete mpRenderPacket; }
+      void Instantiate() override
+      {
+         delete mpRenderPacket;
+         mpRenderPacket = new RenderPacket();
+         mpRenderPacket->mTransform.identity();
+         SetCenter(mX, mY);
+      }
+      void Draw() override {}
+      void SetCenter(float x, float y)
+      {
+         mX = x;
+         mY = y;
+         if (mpRenderPacket)
+         {
+            mpRenderPacket->mTransform[12] = x;
+            mpRenderPacket->mTransform[13] = y;
+         }
+      }
+
+     private:
+      float mX = 0.5f;
+      float mY = 0.25f;
+   };
+
+   bool Near(float a, float b)
+   {
+      return fabsf(a - b) < 1e-4f;
+   }
+
+   bool Check(const char* pName, bool bPass)
+   {
+      printf("%s %s\n", bPass ? "PASS" : "FAIL", pName);
+      return bPass;
+   }
+}
+
+IPlatform& IPlatform::instance(void)
+{
+   static TestPlatform platform;
+   return platform;
+}
+
+int main()
+{
+   Animator& rAnimator = Animator::instance();
+   bool bPass = true;
+
+   // a finished opacity tween, then the shape moves itself
+   TestShape fade;
+   fade.Instantiate();
+   rAnimator.Tween(&fade, Animator::OPACITY, 0.5f, 1.0, Animator::LINEAR);
+   rAnimator.Update(0.0);
+   rAnimator.Update(2.0);
+   fade.SetCenter(-0.3f, 0.1f);
+   rAnimator.Update(3.0);
+   const Matrix4& f = fade.GetRenderPacket()->mTransform;
+   bPass &= Check("SetCenter after a finished tween sticks",
+                  Near(f[12], -0.3f) && Near(f[13], 0.1f) &&
+                     Near(fade.GetRenderPacket()->mfOpacity, 0.5f));
+   bPass &= Check("the animator reads the new position",
+                  Near(rAnimator.Get(&fade, Animator::POSITION_X), -0.3f));
+
+   // moved while a rotation runs: the position sticks, the rotation goes on
+   TestShape spin;
+   spin.Instantiate();
+   rAnimator.Tween(&spin, Animator::ROTATION, 90.0f, 2.0, Animator::LINEAR);
+   rAnimator.Update(10.0);
+   rAnimator.Update(11.0);
+   spin.SetCenter(0.2f, 0.2f);
+   rAnimator.Update(12.0);
+   const Matrix4& s = spin.GetRenderPacket()->mTransform;
+   bPass &= Check("SetCenter during a tween sticks", Near(s[12], 0.2f) && Near(s[13], 0.2f));
+   bPass &= Check("the tween finishes", Near(rAnimator.Get(&spin, Animator::ROTATION), 90.0f));
+
+   // a new packet gets the animated state back
+   rAnimator.Set(&spin, Animator::POSITION_X, 0.7f);
+   spin.Instantiate();
+   rAnimator.Update(13.0);
+   const Matrix4& r = spin.GetRenderPacket()->mTransform;
+   bPass &= Check("a new packet is animated again", Near(r[12], 0.7f) && Near(r[4], -0.75f));
+
+   rAnimator.Remove(&fade);
+   rAnimator.Remove(&spin);
+   return bPass ? 0 : 1;
+}
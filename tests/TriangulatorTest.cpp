@@ -0,0 +1,85 @@
+// Triangulator regression test: the triangles of a polygon with holes must cover exactly the
+// area of the outer loop minus the holes, all counter clockwise.
+#include <math.h>
+#include <stdio.h>
+
+#include "Triangulator.h"
+
+namespace
+{
+   struct Rect
+   {
+      float x0, y0, x1, y1;
+   };
+
+   // Clockwise for the outer loop and counter clockwise for the holes, the Triangulator
+   // fixes the winding either way
+   void AddRect(std::vector<Vector2>& pts, std::vector<int>& loopSizes, const Rect& r, bool bCcw)
+   {
+      if (bCcw)
+      {
+         pts.push_back(Vector2(r.x0, r.y0));
+         pts.push_back(Vector2(r.x1, r.y0));
+         pts.push_back(Vector2(r.x1, r.y1));
+         pts.push_back(Vector2(r.x0, r.y1));
+      }
+      else
+      {
+         pts.push_back(Vector2(r.x0, r.y0));
+         pts.push_back(Vector2(r.x0, r.y1));
+         pts.push_back(Vector2(r.x1, r.y1));
+         pts.push_back(Vector2(r.x1, r.y0));
+      }
+      loopSizes.push_back(4);
+   }
+
+   float Area(const Rect& r)
+   {
+      return (r.x1 - r.x0) * (r.y1 - r.y0);
+   }
+
+   bool Check(const char* pName, const Rect& outer, const std::vector<Rect>& holes)
+   {
+      std::vector<Vector2> pts;
+      std::vector<int> loopSizes;
+      AddRect(pts, loopSizes, outer, false);
+      float expected = Area(outer);
+      for (const Rect& hole : holes)
+      {
+         AddRect(pts, loopSizes, hole, true);
+         expected -= Area(hole);
+      }
+
+      std::vector<uint16_t> indices;
+      bool bOk = Triangulator::Triangulate(pts, loopSizes, indices);
+      float area = 0;
+      bool bCcw = true;
+      for (size_t i = 0; i + 2 < indices.size(); i += 3)
+      {
+         const Vector2& a = pts[indices[i]];
+         const Vector2& b = pts[indices[i + 1]];
+         const Vector2& c = pts[indices[i + 2]];
+         float twice = ((b.x - a.x) * (c.y - a.y)) - ((b.y - a.y) * (c.x - a.x));
+         bCcw = bCcw && (twice > 0);
+         area += twice / 2;
+      }
+
+      bool bPass = bOk && bCcw && (fabsf(area - expected) < 1e-4f);
+      printf("%s %s: returned %d, area %g (expected %g)\n", bPass ? "PASS" : "FAIL", pName,
+             bOk ? 1 : 0, area, expected);
+      return bPass;
+   }
+}
+
+int main()
+{
+   bool bPass = true;
+   bPass &= Check("one hole", {0, 0, 4, 4}, {{1, 1, 3, 3}});
+   bPass &= Check("two holes", {0, 0, 4, 8}, {{1, 1, 3, 3}, {1, 5, 2.5f, 7}});
+   bPass &= Check("two holes, same max x", {0, 0, 4, 8}, {{1, 1, 3, 3}, {1, 5, 3, 7}});
+   bPass &= Check("three holes in a row", {0, 0, 10, 4},
+                  {{1, 1, 2, 3}, {4, 1, 5, 3}, {7, 1, 8, 3}});
+   bPass &= Check("three holes, same max x", {0, 0, 4, 12},
+                  {{1, 1, 3, 3}, {1, 5, 3, 7}, {2, 9, 3, 11}});
+   return bPass ? 0 : 1;
+}
@@ -0,0 +1,455 @@
+//****************************************************************************
+//! @file
+//! @brief Rasterizes fonts ahead of time into a font cache file loaded by
+//! FontLibrary::LoadCache() (see FontCacheFormat.h), so the devices boot without
+//! FreeType opening font files and rasterizing glyphs.
+//!
+//! Usage: FontBaker <fonts.txt> <fonts.bin>
+//!
+//! One font per line, '#' starts a comment, strings are double quoted:
+//!   font <name> "<file>" <pointSize> [sdf] [<first>-<last> | <codepoint>]...
+//! The name is the one the font is registered as, codepoints are decimal or 0x hex and
+//! default to the printable ASCII range (32-126). sdf bakes distance field glyphs
+//! (FontLibrary::RegisterSdf()). The glyphs are rasterized exactly as FontLibrary does.
+//****************************************************************************
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <algorithm>
+#include <map>
+#include <string>
+#include <vector>
+
+#include <ft2build.h>
+#include FT_FREETYPE_H
+#include FT_MODULE_H
+
+#include "FontCacheFormat.h"
+
+using namespace FontCacheFormat;
+
+// FT_RENDER_MODE_SDF appeared in FreeType 2.11
+#if ((FREETYPE_MAJOR * 100) + FREETYPE_MINOR) >= 211
+#define FONT_SDF_SUPPORTED
+#endif
+
+namespace
+{
+   // as FontLibrary: distance field spread and empty texels between the atlas bitmaps
+   const int SDF_SPREAD = 8;
+   const uint32_t PADDING = 1;
+
+   //! @brief Splits a line in tokens (whitespace separated, or double quoted)
+   std::vector<std::string> Tokenize(const char* p)
+   {
+      std::vector<std::string> tokens;
+      while (*p)
+      {
+         while ((*p == ' ') || (*p == '\t') || (*p == '\r') || (*p == '\n'))
+            p++;
+         if ((*p == 0) || (*p == '#'))
+            break;
+         std::string token;
+         if (*p == '"')
+         {
+            p++;
+            while (*p && (*p != '"'))
+               token += *p++;
+            if (*p)
+               p++;
+            tokens.push_back("\"" + token);  // keep the quote to tell strings apart
+         }
+         else
+         {
+            while (*p && (*p != ' ') && (*p != '\t') && (*p != '\r') && (*p != '\n'))
+               token += *p++;
+            tokens.push_back(token);
+         }
+      }
+      return tokens;
+   }
+
+   bool ToCodepoint(const std::string& s, uint32_t& c)
+   {
+      char* pEnd = nullptr;
+      c = static_cast<uint32_t>(strtoul(s.c_str(), &pEnd, 0));
+      return !s.empty() && (*pEnd == 0);
+   }
+
+   //! @brief A rasterized glyph and its place in the atlas
+   struct BakedGlyph
+   {
+      FontCacheGlyph record;
+      std::vector<uint8_t> pixels;  //!< columns * rows bytes
+   };
+
+   struct BakedFont
+   {
+      FontCacheFont record;
+      std::vector<BakedGlyph> glyphs;  //!< Sorted by codepoint
+      std::vector<FontCacheKerning> kerning;
+      std::vector<std::vector<uint8_t>> pages;
+   };
+
+   class Baker
+   {
+     public:
+      Baker() : mLibrary(nullptr) { mStrings.push_back(0); }  // offset 0 is the empty string
+      ~Baker()
+      {
+         if (mLibrary)
+            FT_Done_FreeType(mLibrary);
+      }
+
+      bool Init();
+      bool Line(const char* pLine, int lineNumber);
+      bool Write(const char* pFileName);
+
+     private:
+      bool Rasterize(FT_Face face, uint32_t codepoint, bool bSdf, BakedGlyph& glyph);
+      void Kerning(FT_Face face, BakedFont& font);
+      bool Pack(BakedFont& font);
+      uint32_t AddString(const std::string& s);
+      bool Error(const char* pMessage, const std::string& token) const;
+
+      FT_Library mLibrary;
+      int miLine;
+      std::vector<BakedFont> mFonts;
+      std::vector<char> mStrings;
+   };
+
+   bool Baker::Error(const char* pMessage, const std::string& token) const
+   {
+      fprintf(stderr, "line %d: %s '%s'\n", miLine, pMessage, token.c_str());
+      return false;
+   }
+
+   uint32_t Baker::AddString(const std::string& s)
+   {
+      uint32_t offset = static_cast<uint32_t>(mStrings.size());
+      mStrings.insert(mStrings.end(), s.begin(), s.end());
+      mStrings.push_back(0);
+      return offset;
+   }
+
+   bool Baker::Init()
+   {
+      if (FT_Init_FreeType(&mLibrary) != 0)
+      {
+         fprintf(stderr, "Failed to init freetype library\n");
+         mLibrary = nullptr;
+         return false;
+      }
+#ifdef FONT_SDF_SUPPORTED
+      FT_Int spread = SDF_SPREAD;
+      FT_Property_Set(mLibrary, "sdf", "spread", &spread);
+      FT_Property_Set(mLibrary, "bsdf", "spread", &spread);
+#endif
+      return true;
+   }
+
+   bool Baker::Rasterize(FT_Face face, uint32_t codepoint, bool bSdf, BakedGlyph& glyph)
+   {
+      FT_UInt gindex = FT_Get_Char_Index(face, codepoint);
+      if (!gindex)
+         return false;
+#ifdef FONT_SDF_SUPPORTED
+      if (bSdf)
+      {
+         FT_Load_Glyph(face, gindex, FT_LOAD_NO_HINTING);
+         FT_Render_Glyph(face->glyph, FT_RENDER_MODE_SDF);
+      }
+      else
+#endif
+      {
+         FT_Load_Glyph(face, gindex, FT_LOAD_DEFAULT);
+         FT_Render_Glyph(face->glyph, FT_RENDER_MODE_NORMAL);
+      }
+
+      const FT_GlyphSlot slot = face->glyph;
+      FontCacheGlyph& r = glyph.record;
+      memset(&r, 0, sizeof(r));
+      r.codepoint = codepoint;
+      r.index = gindex;
+      r.advance = static_cast<int32_t>(slot->metrics.horiAdvance);
+      r.height = static_cast<int32_t>(slot->metrics.height);
+      // distance fields extend past the outline by the spread
+      r.bearingX = static_cast<int32_t>(bSdf ? (slot->bitmap_left * 64)
+                                             : slot->metrics.horiBearingX);
+      r.bearingY = static_cast<int32_t>(bSdf ? (slot->bitmap_top * 64)
+                                             : slot->metrics.horiBearingY);
+      r.page = NO_PAGE;
+      if (slot->bitmap.buffer)
+      {
+         r.columns = static_cast<uint16_t>(slot->bitmap.width);
+         r.rows = static_cast<uint16_t>(slot->bitmap.rows);
+         glyph.pixels.resize(r.columns * r.rows);
+         for (uint32_t y = 0; y < r.rows; y++)
+         {
+            memcpy(&glyph.pixels[y * r.columns], &slot->bitmap.buffer[y * slot->bitmap.pitch],
+                   r.columns);
+         }
+      }
+      return true;
+   }
+
+   void Baker::Kerning(FT_Face face, BakedFont& font)
+   {
+      if (!FT_HAS_KERNING(face))
+         return;
+      for (const BakedGlyph& left : font.glyphs)
+      {
+         for (const BakedGlyph& right : font.glyphs)
+         {
+            FT_Vector delta;
+            if ((left.record.index <= 0xFFFF) && (right.record.index <= 0xFFFF) &&
+                (FT_Get_Kerning(face, left.record.index, right.record.index, FT_KERNING_DEFAULT,
+                                &delta) == 0) &&
+                (delta.x != 0))
+            {
+               font.kerning.push_back(
+                  {(left.record.index << 16) | right.record.index, static_cast<int32_t>(delta.x)});
+            }
+         }
+      }
+      std::sort(font.kerning.begin(), font.kerning.end(),
+                [](const FontCacheKerning& a, const FontCacheKerning& b)
+                { return a.pair < b.pair; });
+   }
+
+   bool Baker::Pack(BakedFont& font)
+   {
+      // offline the glyphs can be sorted: tallest first fills the shelves evenly
+      std::vector<BakedGlyph*> order;
+      for (BakedGlyph& glyph : font.glyphs)
+      {
+         if (glyph.record.rows > 0)
+            order.push_back(&glyph);
+      }
+      std::stable_sort(order.begin(), order.end(), [](const BakedGlyph* a, const BakedGlyph* b) {
+         return a->record.rows > b->record.rows;
+      });
+
+      uint32_t x = PAGE_SIZE;  // no page yet
+      uint32_t y = 0;
+      uint32_t shelf = 0;
+      const float scale = 1.0f / PAGE_SIZE;
+      for (BakedGlyph* pGlyph : order)
+      {
+         FontCacheGlyph& r = pGlyph->record;
+         uint32_t w = r.columns + PADDING;
+         uint32_t h = r.rows + PADDING;
+         if ((w > PAGE_SIZE) || (h > PAGE_SIZE))
+         {
+            char codepoint[16];
+            snprintf(codepoint, sizeof(codepoint), "U+%04X", r.codepoint);
+            return Error("glyph too large for an atlas page", codepoint);
+         }
+         if ((x + w) > PAGE_SIZE)
+         {
+            // next shelf, or next page
+            x = 0;
+            y += shelf;
+            shelf = h;
+            if (font.pages.empty() || ((y + h) > PAGE_SIZE))
+            {
+               font.pages.push_back(std::vector<uint8_t>(PAGE_SIZE * PAGE_SIZE, 0));
+               y = 0;
+            }
+         }
+         std::vector<uint8_t>& page = font.pages.back();
+         for (uint32_t row = 0; row < r.rows; row++)
+         {
+            memcpy(&page[((y + row) * PAGE_SIZE) + x], &pGlyph->pixels[row * r.columns],
+                   r.columns);
+         }
+         r.page = static_cast<uint32_t>(font.pages.size() - 1);
+         r.u0 = x * scale;
+         r.v0 = y * scale;
+         r.u1 = (x + r.columns) * scale;
+         r.v1 = (y + r.rows) * scale;
+         x += w;
+      }
+      return true;
+   }
+
+   bool Baker::Line(const char* pLine, int lineNumber)
+   {
+      miLine = lineNumber;
+      std::vector<std::string> tokens = Tokenize(pLine);
+      if (tokens.empty())
+         return true;
+      if (tokens[0] != "font")
+         return Error("unknown element", tokens[0]);
+      if ((tokens.size() < 4) || (tokens[1][0] == '"') || (tokens[2][0] != '"'))
+         return Error("expected font <name> \"<file>\" <pointSize>", tokens[0]);
+      uint32_t pointSize = 0;
+      if (!ToCodepoint(tokens[3], pointSize) || (pointSize == 0))
+         return Error("not a point size", tokens[3]);
+
+      // options and codepoint ranges
+      bool bSdf = false;
+      std::vector<std::pair<uint32_t, uint32_t>> ranges;
+      for (size_t t = 4; t < tokens.size(); t++)
+      {
+         const std::string& o = tokens[t];
+         size_t dash = o.find('-');
+         uint32_t first = 0;
+         uint32_t last = 0;
+         if (o == "sdf")
+         {
+#ifndef FONT_SDF_SUPPORTED
+            return Error("distance field fonts need FreeType 2.11", o);
+#endif
+            bSdf = true;
+         }
+         else if ((dash == std::string::npos) && ToCodepoint(o, first))
+            ranges.push_back({first, first});
+         else if ((dash != std::string::npos) && ToCodepoint(o.substr(0, dash), first) &&
+                  ToCodepoint(o.substr(dash + 1), last) && (first <= last))
+            ranges.push_back({first, last});
+         else
+            return Error("unknown option", o);
+      }
+      if (ranges.empty())
+         ranges.push_back({32, 126});
+
+      const std::string fileName = tokens[2].substr(1);
+      FT_Face face;
+      if (FT_New_Face(mLibrary, fileName.c_str(), 0, &face) != 0)
+         return Error("can't load the font file", fileName);
+      // same size as FontLibrary: points at 96 dpi
+      FT_Set_Char_Size(face, 0, pointSize * 64, 96, 96);
+
+      BakedFont font;
+      memset(&font.record, 0, sizeof(font.record));
+      font.record.name = AddString(tokens[1]);
+      font.record.pointSize = pointSize;
+      font.record.height = static_cast<uint32_t>(face->size->metrics.height >> 6);
+      font.record.ascender = static_cast<int32_t>(face->size->metrics.ascender);
+      font.record.descender = static_cast<int32_t>(face->size->metrics.descender);
+      font.record.flags = bSdf ? static_cast<uint32_t>(SDF) : 0u;
+
+      // the codepoints once each, sorted
+      std::map<uint32_t, bool> codepoints;
+      for (const std::pair<uint32_t, uint32_t>& range : ranges)
+      {
+         for (uint32_t c = range.first; c <= range.second; c++)
+            codepoints[c] = true;
+      }
+      for (const std::pair<const uint32_t, bool>& c : codepoints)
+      {
+         BakedGlyph glyph;
+         if (Rasterize(face, c.first, bSdf, glyph))
+            font.glyphs.push_back(std::move(glyph));
+      }
+      Kerning(face, font);
+      FT_Done_Face(face);
+
+      if (!Pack(font))
+         return false;
+      printf("%s: %zu glyphs, %zu kerning pairs, %zu pages\n", tokens[1].c_str(),
+             font.glyphs.size(), font.kerning.size(), font.pages.size());
+      mFonts.push_back(std::move(font));
+      return true;
+   }
+
+   bool Baker::Write(const char* pFileName)
+   {
+      // tables first, then the strings and the pages
+      uint32_t offset = sizeof(FontCacheHeader) + (mFonts.size() * sizeof(FontCacheFont));
+      for (BakedFont& font : mFonts)
+      {
+         font.record.glyphCount = static_cast<uint32_t>(font.glyphs.size());
+         font.record.glyphOffset = offset;
+         offset += font.record.glyphCount * sizeof(FontCacheGlyph);
+         font.record.kerningCount = static_cast<uint32_t>(font.kerning.size());
+         font.record.kerningOffset = offset;
+         offset += font.record.kerningCount * sizeof(FontCacheKerning);
+      }
+      // keep the pages 4 byte aligned
+      while (mStrings.size() & 3)
+         mStrings.push_back(0);
+      FontCacheHeader h;
+      memset(&h, 0, sizeof(h));
+      h.magic = MAGIC;
+      h.version = VERSION;
+      h.pageSize = PAGE_SIZE;
+      h.fontCount = static_cast<uint32_t>(mFonts.size());
+      h.fontOffset = sizeof(FontCacheHeader);
+      h.stringOffset = offset;
+      h.stringBytes = static_cast<uint32_t>(mStrings.size());
+      offset += h.stringBytes;
+      for (BakedFont& font : mFonts)
+      {
+         font.record.pageCount = static_cast<uint32_t>(font.pages.size());
+         font.record.pageOffset = offset;
+         offset += font.record.pageCount * PAGE_SIZE * PAGE_SIZE;
+      }
+
+      FILE* fp = fopen(pFileName, "wb");
+      if (!fp)
+      {
+         fprintf(stderr, "Can't create %s\n", pFileName);
+         return false;
+      }
+      bool bOk = (fwrite(&h, sizeof(h), 1, fp) == 1);
+      for (const BakedFont& font : mFonts)
+         bOk = bOk && (fwrite(&font.record, sizeof(FontCacheFont), 1, fp) == 1);
+      for (const BakedFont& font : mFonts)
+      {
+         for (const BakedGlyph& glyph : font.glyphs)
+            bOk = bOk && (fwrite(&glyph.record, sizeof(FontCacheGlyph), 1, fp) == 1);
+         bOk = bOk && (fwrite(font.kerning.data(), sizeof(FontCacheKerning), font.kerning.size(),
+                              fp) == font.kerning.size());
+      }
+      bOk = bOk && (fwrite(mStrings.data(), 1, mStrings.size(), fp) == mStrings.size());
+      for (const BakedFont& font : mFonts)
+      {
+         for (const std::vector<uint8_t>& page : font.pages)
+            bOk = bOk && (fwrite(page.data(), 1, page.size(), fp) == page.size());
+      }
+      if (fclose(fp) != 0)
+         bOk = false;
+      if (!bOk)
+         fprintf(stderr, "Error writing %s\n", pFileName);
+      return bOk;
+   }
+}
+
+int main(int argc, char* argv[])
+{
+   if (argc != 3)
+   {
+      fprintf(stderr, "Usage: %s <fonts.txt> <fonts.bin>\n", argv[0]);
+      return EXIT_FAILURE;
+   }
+   FILE* fp = fopen(argv[1], "r");
+   if (!fp)
+   {
+      fprintf(stderr, "Can't open %s\n", argv[1]);
+      return EXIT_FAILURE;
+   }
+
+   Baker baker;
+   bool bOk = baker.Init();
+   // lines of any length: long range lists are read in chunks
+   std::string line;
+   char chunk[256];
+   int lineNumber = 0;
+   while (bOk && fgets(chunk, sizeof(chunk), fp))
+   {
+      line += chunk;
+      if ((line.back() != '\n') && !feof(fp))
+         continue;
+      bOk = baker.Line(line.c_str(), ++lineNumber);
+      line.clear();
+   }
+   fclose(fp);
+
+   if (!bOk || !baker.Write(argv[2]))
+   {
+      return EXIT_FAILURE;
+   }
+   return EXIT_SUCCESS;
+}
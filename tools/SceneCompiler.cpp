@@ -0,0 +1,285 @@
+//****************************************************************************
+//! @file
+//! @brief Converts a text scene description to the binary scene format loaded by
+//! SceneLoader (see SceneFormat.h).
+//!
+//! Usage: SceneCompiler <scene.txt> <scene.bin>
+//!
+//! One element per line, '#' starts a comment, strings are double quoted:
+//!   style <name> <fill r g b a> <stroke r g b a> <strokeWidth> <opacity>
+//!   line <x0> <y0> <x1> <y1> <width>
+//!   circle <x> <y> <radius> <sides>
+//!   circleline <x> <y> <radius> <sides>
+//!   fanline <x> <y> <radius> <sides> <start> <stop>
+//!   fan <x> <y> <radius> <sides> <start> <stop>
+//!   roundrect <x0> <y0> <x1> <y1> <width>
+//!   sprite <x> <y> <w> <h> "<image>"
+//!   text <x> <y> <w> <h> "<font>" "<content>"
+//! Shapes accept the options style=<name>, sdf, aa and (roundrect) filled.
+//****************************************************************************
+#include <math.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <map>
+#include <string>
+#include <vector>
+
+#include "SceneFormat.h"
+
+using namespace SceneFormat;
+
+namespace
+{
+   struct Keyword
+   {
+      const char* pName;
+      Type type;
+      int numbers;  //!< Numbers following the keyword
+      int strings;  //!< Quoted strings following the numbers
+   };
+
+   const Keyword KEYWORDS[] = {
+      {"line", LINE, 5, 0},
+      {"circle", CIRCLE, 4, 0},
+      {"circleline", CIRCLE_LINE, 4, 0},
+      {"fanline", FAN_LINE, 6, 0},
+      {"fan", FAN, 6, 0},
+      {"roundrect", ROUND_RECT, 5, 0},
+      {"sprite", SPRITE, 4, 1},
+      {"text", TEXT, 4, 2},
+   };
+
+   //! @brief Splits a line in tokens (whitespace separated, or double quoted)
+   std::vector<std::string> Tokenize(const char* p)
+   {
+      std::vector<std::string> tokens;
+      while (*p)
+      {
+         while ((*p == ' ') || (*p == '\t') || (*p == '\r') || (*p == '\n'))
+            p++;
+         if ((*p == 0) || (*p == '#'))
+            break;
+         std::string token;
+         if (*p == '"')
+         {
+            p++;
+            while (*p && (*p != '"'))
+               token += *p++;
+            if (*p)
+               p++;
+            tokens.push_back("\"" + token);  // keep the quote to tell strings apart
+         }
+         else
+         {
+            while (*p && (*p != ' ') && (*p != '\t') && (*p != '\r') && (*p != '\n'))
+               token += *p++;
+            tokens.push_back(token);
+         }
+      }
+      return tokens;
+   }
+
+   bool ToFloat(const std::string& s, float& f)
+   {
+      char* pEnd = nullptr;
+      f = strtof(s.c_str(), &pEnd);
+      return !s.empty() && (*pEnd == 0);
+   }
+
+   class Compiler
+   {
+     public:
+      Compiler() { mStrings.push_back(0); }  // offset 0 is the empty string
+
+      bool Line(const char* pLine, int lineNumber);
+      bool Write(const char* pFileName) const;
+
+     private:
+      bool Style(const std::vector<std::string>& tokens);
+      uint32_t AddString(const std::string& s);
+      bool Error(const char* pMessage, const std::string& token) const;
+
+      int miLine;
+      std::map<std::string, uint32_t> mStyleNames;
+      std::vector<SceneStyle> mStyles;
+      std::vector<SceneRecord> mRecords;
+      std::vector<char> mStrings;
+   };
+
+   bool Compiler::Error(const char* pMessage, const std::string& token) const
+   {
+      fprintf(stderr, "line %d: %s '%s'\n", miLine, pMessage, token.c_str());
+      return false;
+   }
+
+   uint32_t Compiler::AddString(const std::string& s)
+   {
+      uint32_t offset = static_cast<uint32_t>(mStrings.size());
+      mStrings.insert(mStrings.end(), s.begin(), s.end());
+      mStrings.push_back(0);
+      return offset;
+   }
+
+   bool Compiler::Style(const std::vector<std::string>& tokens)
+   {
+      if (tokens.size() != 12)
+         return Error("style needs a name and 10 numbers", tokens[0]);
+      float v[10];
+      for (int i = 0; i < 10; i++)
+      {
+         if (!ToFloat(tokens[i + 2], v[i]))
+            return Error("not a number", tokens[i + 2]);
+      }
+      SceneStyle s;
+      memcpy(s.fill, v, sizeof(s.fill));
+      memcpy(s.stroke, v + 4, sizeof(s.stroke));
+      s.strokeWidth = v[8];
+      s.opacity = v[9];
+      mStyleNames[tokens[1]] = static_cast<uint32_t>(mStyles.size());
+      mStyles.push_back(s);
+      return true;
+   }
+
+   bool Compiler::Line(const char* pLine, int lineNumber)
+   {
+      miLine = lineNumber;
+      std::vector<std::string> tokens = Tokenize(pLine);
+      if (tokens.empty())
+         return true;
+      if (tokens[0] == "style")
+         return Style(tokens);
+
+      const Keyword* pKeyword = nullptr;
+      for (const Keyword& k : KEYWORDS)
+      {
+         if (tokens[0] == k.pName)
+            pKeyword = &k;
+      }
+      if (!pKeyword)
+         return Error("unknown element", tokens[0]);
+      if (tokens.size() < size_t(1 + pKeyword->numbers + pKeyword->strings))
+         return Error("missing arguments for", tokens[0]);
+
+      SceneRecord r;
+      memset(&r, 0, sizeof(r));
+      r.type = pKeyword->type;
+      r.style = NO_STYLE;
+
+      // numbers, the sides of the round shapes go to count
+      bool bSides = (r.type >= CIRCLE) && (r.type <= FAN);
+      size_t t = 1;
+      int f = 0;
+      for (int i = 0; i < pKeyword->numbers; i++, t++)
+      {
+         float v;
+         if (!ToFloat(tokens[t], v))
+            return Error("not a number", tokens[t]);
+         if (bSides && (i == 3))
+         {
+            // checked as a float, the cast of an out of range value is undefined
+            if ((v != floorf(v)) || (v < MIN_SIDES) || (v > MAX_SIDES))
+               return Error("sides must be a whole number from 3 to 4096", tokens[t]);
+            r.count = static_cast<uint32_t>(v);
+         }
+         else
+            r.f[f++] = v;
+      }
+      for (int i = 0; i < pKeyword->strings; i++, t++)
+      {
+         if (tokens[t][0] != '"')
+            return Error("expected a quoted string", tokens[t]);
+         uint32_t offset = AddString(tokens[t].substr(1));
+         (i == 0 ? r.text : r.text2) = offset;
+      }
+
+      // options
+      for (; t < tokens.size(); t++)
+      {
+         const std::string& o = tokens[t];
+         if (o == "sdf")
+            r.flags |= SDF;
+         else if (o == "aa")
+            r.flags |= ANTIALIAS;
+         else if ((o == "filled") && (r.type == ROUND_RECT))
+            r.flags |= FILLED;
+         else if (o.compare(0, 6, "style=") == 0)
+         {
+            auto it = mStyleNames.find(o.substr(6));
+            if (it == mStyleNames.end())
+               return Error("undefined style", o);
+            r.style = it->second;
+         }
+         else
+            return Error("unknown option", o);
+      }
+      mRecords.push_back(r);
+      return true;
+   }
+
+   bool Compiler::Write(const char* pFileName) const
+   {
+      SceneHeader h;
+      h.magic = MAGIC;
+      h.version = VERSION;
+      h.styleCount = static_cast<uint32_t>(mStyles.size());
+      h.recordCount = static_cast<uint32_t>(mRecords.size());
+      h.styleOffset = sizeof(SceneHeader);
+      h.recordOffset = h.styleOffset + (h.styleCount * sizeof(SceneStyle));
+      h.stringOffset = h.recordOffset + (h.recordCount * sizeof(SceneRecord));
+      h.stringBytes = static_cast<uint32_t>(mStrings.size());
+
+      FILE* fp = fopen(pFileName, "wb");
+      if (!fp)
+      {
+         fprintf(stderr, "Can't create %s\n", pFileName);
+         return false;
+      }
+      bool bOk = (fwrite(&h, sizeof(h), 1, fp) == 1) &&
+                 (fwrite(mStyles.data(), sizeof(SceneStyle), mStyles.size(), fp) == mStyles.size()) &&
+                 (fwrite(mRecords.data(), sizeof(SceneRecord), mRecords.size(), fp) == mRecords.size()) &&
+                 (fwrite(mStrings.data(), 1, mStrings.size(), fp) == mStrings.size());
+      if (fclose(fp) != 0)
+         bOk = false;
+      if (!bOk)
+         fprintf(stderr, "Error writing %s\n", pFileName);
+      return bOk;
+   }
+}
+
+int main(int argc, char* argv[])
+{
+   if (argc != 3)
+   {
+      fprintf(stderr, "Usage: %s <scene.txt> <scene.bin>\n", argv[0]);
+      return EXIT_FAILURE;
+   }
+   FILE* fp = fopen(argv[1], "r");
+   if (!fp)
+   {
+      fprintf(stderr, "Can't open %s\n", argv[1]);
+      return EXIT_FAILURE;
+   }
+
+   Compiler compiler;
+   // lines of any length: long text records are read in chunks
+   std::string line;
+   char chunk[256];
+   int lineNumber = 0;
+   bool bOk = true;
+   while (bOk && fgets(chunk, sizeof(chunk), fp))
+   {
+      line += chunk;
+      if ((line.back() != '\n') && !feof(fp))
+         continue;
+      bOk = compiler.Line(line.c_str(), ++lineNumber);
+      line.clear();
+   }
+   fclose(fp);
+
+   if (!bOk || !compiler.Write(argv[2]))
+   {
+      return EXIT_FAILURE;
+   }
+   return EXIT_SUCCESS;
+}